@@ -42,6 +42,7 @@ $Config = @{
     AggroReminderPeriod = 12; # aggressive reminder 12hrs before event starts
     PreviewPeriod       = 24; # If no event is within PreviewPeriod + CosyReminderPeriod the Rememberall will sleep for PreviewPeriod hours
     maxCharsPerLine     = 10; # max amount of characters displayable in 1 ePaper line of the Rememberall
+    maxCharsPerLineIcon = 8; # max amount of characters per line if an icon is shown (D_CHARS_PER_LINE_ICON)
     maxLines            = 3; # max number of lines that can be displayed
     eventAckStr         = "ack"; # filtered string of t_Status; at match, current event has been acknowledged on the Rememberall
     ActiveReminderHours = [ordered]@{
@@ -59,46 +60,55 @@ $MQTT.t_Reminder = "$($MQTT.TopicTree)/eventReminder"
 $MQTT.t_Txt = "$($MQTT.TopicTree)/eventTxt"
 $MQTT.t_SleepUntil = "$($MQTT.TopicTree)/SleepUntil"
 $MQTT.t_Status = "$($MQTT.TopicTree)/Status" # subscribed topic; if "ack", current event already acknowledged by user
+$MQTT.t_Journal = "$($MQTT.TopicTree)/Journal" # subscribed topic; user actions journaled by the Rememberall ("Seq;Action;EpochHex;DeadlineHex|...")
+$MQTT.t_Manifest = "$($MQTT.TopicTree)/Manifest" # content manifest for the Rememberall ("VersionHex;eventTxtHashHex;eventReminderHashHex"), see CONTENT_MANIFEST
 
 # Filters and assigned LED-colors for Calendar Events
 # will be filtered with -imatch from the "Summary" field of suitable events
-# LEDColor = 0xRRGGBB ; use powerful colors, bright ones may look like white on the RGB LEDs (possibly due to low brightness / powered by 3.3V)
+# LEDColor = 0xRRGGBB ; use powerful colors, bright ones may look like white on the RGB LEDs (low brightness / powered by 3.3V; LED_RENDER in the firmware helps)
 # TXTColor = 0 (black) or 1 (red)
+# Icon = IconID shown left of the text on the ePaper (see sprites.h of the Rememberall firmware); 0 = no icon
+#        1 = trash can, 2 = ball, 3 = birthday cake, 4 = red cross
 $EventFilter = [ordered]@{
     Sports    = @{
         Regex     = @('Badminton|Klettern|Wandern'); # different keywords to search for category sport
         LEDColor  = @('0x00FF00'); # they will all get the same color assigned
         TXTColor  = @(1);
-        TXTPrefix = @('0;Sport:'); # Text line prefixed to the first word of the summary text, starting with "TXTColor;"
-        TXTSuffix = @('') # Text line suffixed
+        TXTPrefix = @(''); # Text line prefixed to the first word of the summary text, starting with "TXTColor;"
+        TXTSuffix = @(''); # Text line suffixed
+        Icon      = @(2) # an icon saves a whole prefix line
     };
     Household = @{
         Regex     = @('Biomüll', 'Restmüll', 'gelber Sack'); # you can have multiple types in a category
         LEDColor  = @('0x00FF00', '0x0000FF', '0xFFFF00'); # with different colors/prefixes/suffixes assigned
         TXTColor  = @(1, 1, 1);
-        TXTPrefix = @('0;Tonne' , '0;Tonne', '');
-        TXTSuffix = @('0;raus!', '0;raus!', '0;raus!')
+        TXTPrefix = @('', '', '');
+        TXTSuffix = @('0;raus!', '0;raus!', '0;raus!');
+        Icon      = @(1, 1, 1)
     };
     Birthdays = @{
         Regex     = @('Geburtstag');
         LEDColor  = @('0xFF7A01');
         TXTColor  = @(1);
-        TXTPrefix = @('0;Geburtstag');
-        TXTSuffix = @('')
+        TXTPrefix = @('');
+        TXTSuffix = @('');
+        Icon      = @(3)
     };
     Health    = @{
         Regex     = @('Physio|Arzt|Massage');
         LEDColor  = @('0xFF0000');
         TXTColor  = @(1);
-        TXTPrefix = @('1;Termin:');
-        TXTSuffix = @('')
+        TXTPrefix = @('');
+        TXTSuffix = @('');
+        Icon      = @(4)
     };
     Others    = @{ # NOTE: This must be the LAST category in the EventFilter hashtable!
         Regex     = @('.*'); # Fallback for events where no other category matches
         LEDColor  = @('0xFF00FF');
         TXTColor  = @(1);
         TXTPrefix = @('');
-        TXTSuffix = @('')
+        TXTSuffix = @('');
+        Icon      = @(0)
     };
 }
 
@@ -132,9 +142,11 @@ Register-ObjectEvent `
 # Subscribe to the eventTxt topic (used to compare if updating MQTT topics is necessary)
 $MqttClient.Subscribe("$($MQTT.t_Txt)", 0) | Out-Null # Subscribe with QoS 0
 $MqttClient.Subscribe("$($MQTT.t_Status)", 0) | Out-Null
-# Global variables for received eventTXT and Status messages
+$MqttClient.Subscribe("$($MQTT.t_Journal)", 0) | Out-Null
+# Global variables for received eventTXT, Status and Journal messages
 $Global:MqttTxtTopicMessage = "none"
 $Global:MqttStatusTopicMessage = "none"
+$Global:MqttJournalTopicMessage = ""
 #endregion
 
 
@@ -151,6 +163,7 @@ function global:MQTTMsgReceived {
     switch ($topic) {
         $MQTT.t_Txt { $Global:MqttTxtTopicMessage = $([System.Text.Encoding]::ASCII.GetString($MqttRcv.Message)) }
         $MQTT.t_Status { $Global:MqttStatusTopicMessage = $([System.Text.Encoding]::ASCII.GetString($MqttRcv.Message)) }
+        $MQTT.t_Journal { $Global:MqttJournalTopicMessage = $([System.Text.Encoding]::ASCII.GetString($MqttRcv.Message)) }
     }
 }
 
@@ -197,6 +210,14 @@ function Get-EventInfo {
                 $TextLines = 0
                 $HasPrefix = $false
                 $HasSuffix = $false
+                # Icon reduces the available characters per line
+                $IconId = $EventFilter.$Category.Icon[$i]
+                if ($IconId -gt 0) {
+                    $CharsPerLine = $Config.maxCharsPerLineIcon
+                }
+                else {
+                    $CharsPerLine = $Config.maxCharsPerLine
+                }
 
                 if ($EventFilter.$Category.TXTPrefix[$i].Length -gt 0) {
                     $HasPrefix = $true
@@ -212,13 +233,13 @@ function Get-EventInfo {
                 # Start creating the text string with a placeholder for the number of lines
                 $EventInfo.Text.Msg = "LC_Ph"
                 if ($HasPrefix) {
-                    $EventInfo.Text.Msg = $EventInfo.Text.Msg + "|" + $(Convert-Trim-String $EventFilter.$Category.TXTPrefix[$i] -Length ($Config.maxCharsPerLine + 2)) # TXTPrefix also contains color, thus +2 chars
+                    $EventInfo.Text.Msg = $EventInfo.Text.Msg + "|" + $(Convert-Trim-String $EventFilter.$Category.TXTPrefix[$i] -Length ($CharsPerLine + 2)) # TXTPrefix also contains color, thus +2 chars
                 }
 
                 # Add allowed/available amount of words of the Events Summary field (one word per line)
                 $SummaryWordCount = $Event.Summary.Split(" ").Count
                 for ($word = 0; $word -lt $SummaryWordCount; $word++) {
-                    $EventInfo.Text.Msg = $EventInfo.Text.Msg + "|" + $($EventFilter.$Category.TXTColor[$i]) + ";" + $(Convert-Trim-String $Event.Summary.Split(" ")[$word] -Length $Config.maxCharsPerLine)
+                    $EventInfo.Text.Msg = $EventInfo.Text.Msg + "|" + $($EventFilter.$Category.TXTColor[$i]) + ";" + $(Convert-Trim-String $Event.Summary.Split(" ")[$word] -Length $CharsPerLine)
                     $TextLines++
                     if ($TextLines -eq $Config.maxLines) {
                         # All lines filled
@@ -227,10 +248,15 @@ function Get-EventInfo {
                 }
                 
                 if ($HasSuffix) {
-                    $EventInfo.Text.Msg = $EventInfo.Text.Msg + "|" + $(Convert-Trim-String $EventFilter.$Category.TXTSuffix[$i] -Length ($Config.maxCharsPerLine + 2)) # TXTSuffix also contains color, thus +2 chars
+                    $EventInfo.Text.Msg = $EventInfo.Text.Msg + "|" + $(Convert-Trim-String $EventFilter.$Category.TXTSuffix[$i] -Length ($CharsPerLine + 2)) # TXTSuffix also contains color, thus +2 chars
+                }
+                # Replace Linecount placeholder (and append IconID if any) to finish the final text message for Rememberall
+                if ($IconId -gt 0) {
+                    $EventInfo.Text.Msg = $EventInfo.Text.Msg.replace('LC_Ph', "$($TextLines);$($IconId)")
+                }
+                else {
+                    $EventInfo.Text.Msg = $EventInfo.Text.Msg.replace('LC_Ph', "$($TextLines)")
                 }
-                # Replace Linecount placeholder to finish the final text message for Rememberall
-                $EventInfo.Text.Msg = $EventInfo.Text.Msg.replace('LC_Ph', "$($TextLines)")
                 # Get desired LED color
                 $EventInfo.Reminder.LEDColor = $EventFilter.$Category.LEDColor[$i]
                 # Build final Reminder message for Rememberall
@@ -263,6 +289,35 @@ function Convert-Trim-String {
     return $Str[0..($Length - 1)] -join ""
 }
 
+# Returns the FNV-1a (32 bit) hash of an ASCII string in hexadecimal base (same as ManifestHash of the Rememberall firmware)
+function Get-Fnv1aHash {
+    param (
+        [parameter(Mandatory = $True, Position = 1)] [string] $Str
+    )
+    [uint64]$Hash = 2166136261
+    foreach ($Byte in [System.Text.Encoding]::ASCII.GetBytes($Str)) {
+        $Hash = (($Hash -bxor $Byte) * 16777619) % 4294967296
+    }
+    return $Hash.ToString("x")
+}
+
+# Returns $true if the journal published by the Rememberall contains an acknowledge for the event with the given deadline (hex epoch)
+# The journal may contain entries already processed in previous runs (identified by their sequence number), which is fine here
+function Test-JournalAck {
+    param (
+        [parameter(Mandatory = $True, Position = 1)] [AllowEmptyString()] [string] $Journal
+        , [parameter(Mandatory = $True, Position = 2)] [string] $DeadlineHex
+    )
+    foreach ($Entry in $Journal.Split("|")) {
+        $Fields = $Entry.Split(";")
+        # Fields: Seq;Action;EpochHex;DeadlineHex
+        if ($Fields.Count -eq 4 -and $Fields[1] -eq "A" -and [Convert]::ToInt64($Fields[3], 16) -eq [Convert]::ToInt64($DeadlineHex, 16)) {
+            return $true
+        }
+    }
+    return $false
+}
+
 # Returns a SleepUntil Epoch time according to Config
 function Calculate-SleepUntil {
     Param
@@ -385,6 +440,8 @@ if ($NextEventCandidates.Count -gt 0) {
         }
         # Only send if update is needed (new event) or ForceUpdate param set $true
         if ($Global:MqttTxtTopicMessage -ne $SendMe.Text.Msg -or $ForceUpdate) {
+            # Content manifest: version (epoch of this update) and hashes of the event topics
+            $Manifest = "$(Get-EpochFromNow);$(Get-Fnv1aHash $SendMe.Text.Msg);$(Get-Fnv1aHash $SendMe.Reminder.Msg)"
             if (-not $WhatIf) {
                 $MqttClient.Publish($MQTT.t_Txt, [System.Text.Encoding]::ASCII.GetBytes($SendMe.Text.Msg), 1, 1) | Out-Null # Publish with QoS 1 and Retained
                 Write-Host "Text message sent to broker: $($SendMe.Text.Msg)"
@@ -392,17 +449,20 @@ if ($NextEventCandidates.Count -gt 0) {
                 Write-Host "Reminder message sent to broker: $($SendMe.Reminder.Msg)"
                 $MqttClient.Publish($MQTT.t_Status, [System.Text.Encoding]::ASCII.GetBytes("newEvent"), 1, 1) | Out-Null
                 Write-Host "Status message reset to newEvent."
+                $MqttClient.Publish($MQTT.t_Manifest, [System.Text.Encoding]::ASCII.GetBytes($Manifest), 1, 1) | Out-Null
+                Write-Host "Manifest message sent to broker: $($Manifest)"
             }
             else {
                 Write-Host "WHATIF: Send Text message to broker: $($SendMe.Text.Msg)" -ForegroundColor Magenta
                 Write-Host "WHATIF: Send Reminder message to broker: $($SendMe.Reminder.Msg)" -ForegroundColor Magenta
                 Write-Host "WHATIF: Reset Status message to newEvent." -ForegroundColor Magenta
+                Write-Host "WHATIF: Send Manifest message to broker: $($Manifest)" -ForegroundColor Magenta
             }
             $EventIsActive = $true
         }
         else {
             Write-Host "MQTT event topics already up-to-date, check if acknowledged by user.." -ForegroundColor Green
-            if ($Global:MqttStatusTopicMessage -eq $Config.eventAckStr) {
+            if ($Global:MqttStatusTopicMessage -eq $Config.eventAckStr -or (Test-JournalAck $Global:MqttJournalTopicMessage $SendMe.Reminder.Deadline)) {
                 Write-Host "The current event has been acknowledged on the Rememberall. Ignoring this event." -ForegroundColor Yellow
                 $EventIsActive = $false
             }
@@ -12,14 +12,24 @@
 // Declare common functions
 //
 extern void ToggleLed(int PIN, int WaitTime, int Count);
+extern void EnterDeepSleep(uint32_t Seconds, int ButtonGpio);
 extern void MqttCallback(char *topic, byte *payload, unsigned int length);
 extern bool MqttSubscribe(const char *Topic);
+extern bool MqttTopicsMissing(bool WithOptional);
 extern bool MqttConnectToBroker();
 extern void MqttUpdater();
 extern void MqttDelay(uint32_t delayms);
 extern bool OTAUpdateHandler();
 extern void wifi_up();
 extern void wifi_down();
+#ifdef MEM_REPORT
+extern void PublishMemStats();
+#endif
+#ifdef CONNECTED_IDLE
+extern void ConnectedIdleEnter();
+extern bool ConnectedIdle();
+extern bool ConnectedIdleBusy; // set by user_loop while it needs a fast main loop (e.g. LED ring animation)
+#endif
 
 //
 // Declare common global vars
@@ -27,5 +37,8 @@ extern void wifi_down();
 extern bool JustBooted;
 extern bool DelayDeepSleep;
 extern uint32_t UptimeSeconds;
+#ifdef DIAG_RING
+extern unsigned long WiFiStartMillis; // millis() when WiFi was started (diagnostic phase timing)
+#endif
 
 #endif // COMMON_FUNCTIONS_H
\ No newline at end of file
@@ -0,0 +1,32 @@
+/*
+ *   ESP32 Rememberall
+ *   Countdown overlay schedule declarations
+ */
+#ifndef COUNTDOWN_H
+#define COUNTDOWN_H
+
+#include <Arduino.h>
+#include "mqtt-ota-config.h"
+#include "user-config.h"
+
+#ifdef D_COUNTDOWN
+//
+// Precomputed countdown refresh schedule for the current event
+// Entries are sorted ascending; at most D_CD_MAX_UPDATES partial display refreshes per event
+//
+struct CountdownSchedule
+{
+    time_t UpdateAt[D_CD_MAX_UPDATES]; // epoch times of scheduled countdown refreshes
+    int Cnt = 0;                       // number of valid entries in UpdateAt
+    int Next = 0;                      // index of the next pending entry
+};
+
+// Calculate refresh schedule for the given event (call after decoding a new reminder message)
+extern void CountdownPlan(CountdownSchedule *Sched, eventInfoStruct *EventData, time_t Now);
+// Returns true if a scheduled refresh is due (entries missed e.g. during WiFi handling are collapsed into one refresh)
+extern bool CountdownDue(CountdownSchedule *Sched, time_t Now);
+// Format remaining time to a short string ("45m", "17h", "3d"); Buf must hold at least 4 chars
+extern void CountdownFormat(char *Buf, size_t BufLen, time_t Remaining);
+#endif // D_COUNTDOWN
+
+#endif // COUNTDOWN_H
@@ -0,0 +1,53 @@
+/*
+ *   ESP32 Template
+ *   Remote diagnostics declarations
+ */
+#ifndef DIAG_H
+#define DIAG_H
+
+#include <Arduino.h>
+#include "mqtt-ota-config.h"
+
+//
+// Diagnostics ring buffer
+// The last DIAG_RING_SIZE records are kept in RTC memory (survives DeepSleep and software resets, requires KEEP_RTC_SLOWMEM).
+// Nothing is sent unless requested: set diag_req_topic to "on" (retained) and the records will be published
+// to diag_topic at the next connection; the device resets diag_req_topic to "off" afterwards.
+//
+#define DIAG_RING_SIZE 48
+#define DIAG_MAGIC 0x44494147 // marks initialized ring buffer in RTC memory
+
+// Record types and codes
+#define DIAG_BOOT 'B'   // Code = esp_reset_reason(), Value = esp_sleep_get_wakeup_cause()
+#define DIAG_PHASE 'P'  // Code = DIAG_PH_x, Value = duration in ms
+#define DIAG_DECODE 'D' // Code = DIAG_DEC_x, Value = detail (failing line / token count)
+#define DIAG_NET 'N'    // Code = DIAG_NET_x, Value = reconnect tries / MQTT client state
+#define DIAG_PH_WIFI 1     // WiFi connect
+#define DIAG_PH_MQTT 2     // MQTT connect, subscribe and receive retained messages
+#define DIAG_PH_SESSION 3  // WiFi up until WiFi down
+#define DIAG_PH_IDLE 4     // connected idle (CONNECTED_IDLE), in seconds
+#define DIAG_DEC_TXT 1     // eventTxt message
+#define DIAG_DEC_REMINDER 2 // eventReminder message
+#define DIAG_NET_RECONN 1  // network recovery failed (Value = netfail_reconn_tries)
+#define DIAG_NET_MQTT 2    // MQTT connect failed (Value = mqttClt.state())
+
+#ifdef DIAG_RING
+struct DiagRecord
+{
+    uint32_t Epoch; // system time when the record was added (may be invalid after power loss)
+    int32_t Value;  // record value
+    uint8_t Type;   // DIAG_x record type
+    uint8_t Code;   // record code
+};
+
+// Add a record to the ring buffer (use DIAG_ADD macro)
+extern void DiagAdd(uint8_t Type, uint8_t Code, int32_t Value);
+// Publish all records to diag_topic if requested via diag_req_topic (call in main loop while connected)
+extern void DiagHandle();
+extern bool DiagRequest;
+#define DIAG_ADD(Type, Code, Value) DiagAdd((Type), (Code), (Value))
+#else
+#define DIAG_ADD(Type, Code, Value)
+#endif // DIAG_RING
+
+#endif // DIAG_H
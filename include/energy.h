@@ -0,0 +1,58 @@
+/*
+ *   ESP32 Rememberall
+ *   Energy accounting declarations
+ */
+#ifndef ENERGY_H
+#define ENERGY_H
+
+#include <Arduino.h>
+#include "mqtt-ota-config.h"
+#include "user-config.h"
+
+#ifdef ENERGY_STATS
+//
+// Energy accounting
+// The time spent in each state is measured and multiplied with the current coefficients below.
+// Durations of the current day (UTC) are kept in RTC memory; when the day changes, the breakdown of the finished day
+// is published (retained) to energy_topic as "Day_epoch_in_hex;mAh_per_state;...;mAh_total;Projected_runtime_in_days"
+// (states in the order of the EN_x defines). Up to EN_PENDING_DAYS finished days are kept until they can be published;
+// DeepSleep periods spanning midnight are split between the days. The projection is based on the consumption of the finished day and the
+// charge consumed since the last power loss (battery change).
+//
+// Base states (exactly one at a time)
+#define EN_ACTIVE 0  // CPU awake, WiFi off
+#define EN_ASSOC 1   // WiFi association
+#define EN_SESSION 2 // WiFi connected (MQTT session, network failure recovery)
+#define EN_IDLE 3    // connected idle (CONNECTED_IDLE)
+#define EN_SLEEP 4   // DeepSleep
+// Additional consumers (on top of the base state)
+#define EN_EPAPER 5 // ePaper refresh
+#define EN_LED 6    // LED ring powered (EMB_PWS_U2)
+#define EN_CNT 7
+
+// Current coefficients in mA (measure your hardware and adopt!)
+#define EN_MA_ACTIVE 25.0f
+#define EN_MA_ASSOC 90.0f
+#define EN_MA_SESSION 70.0f
+#define EN_MA_IDLE 20.0f
+#define EN_MA_SLEEP 0.05f // incl. quiescent current of the voltage regulator
+#define EN_MA_EPAPER 8.0f
+#define EN_MA_LED 40.0f
+#define EN_BATTERY_MAH 1500.0f // battery capacity
+#define EN_PENDING_DAYS 7      // finished days kept in RTC memory until published
+
+// Account the time since the last call to the current base state (call in main loop)
+extern void EnergyHandle();
+// Account a measured duration of a blocking phase (EN_ASSOC) that would otherwise count as the current base state
+extern void EnergyAdd(int State, uint32_t Ms);
+// Switch an additional consumer (EN_EPAPER, EN_LED) on or off
+extern void EnergyOn(int Consumer, bool On);
+// Close the accounting before DeepSleep; SleepUs is used if the RTC time is not valid after wakeup
+extern void EnergySleep(uint64_t SleepUs);
+// Account the DeepSleep duration (call in setup after the clock has been restored)
+extern void EnergyBoot();
+// Publish the breakdown of finished days (call in main loop while connected)
+extern void EnergyPublish();
+#endif // ENERGY_STATS
+
+#endif // ENERGY_H
@@ -0,0 +1,40 @@
+/*
+ *   ESP32 Rememberall
+ *   NVS backed event store declarations
+ */
+#ifndef EVENTSTORE_H
+#define EVENTSTORE_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "mqtt-ota-config.h"
+#include "user-config.h"
+
+//
+// Event Store Configuration
+//
+// The decoded event (eventInfoStruct) and its acknowledge state are persisted in NVS,
+// so that reminders continue after a reboot or brownout without the MQTT broker.
+// Writes only happen if the data has changed; updates arriving in a burst (eventTxt, eventReminder, Status)
+// are coalesced into a single NVS write after EVS_COALESCE_MS or when the MQTT session ends.
+#define EVS_KEY "event"
+#define EVS_VERSION 1 // increase when changing the EventStoreRecord layout
+#define EVS_COALESCE_MS 5000 // delay NVS writes for this amount of ms after the last change
+
+struct EventStoreRecord
+{
+    uint16_t Version;          // EVS_VERSION
+    bool TxtValid;             // TextLines, LineCol, LineCnt and IconId have been decoded
+    bool ReminderValid;        // Deadline, reminders and LedColor have been decoded
+    bool Acknowledged;         // event acknowledged by the user
+    eventInfoStruct EventInfo; // decoded event data
+};
+
+// Restore event from NVS; returns false if nothing (valid) has been stored
+extern bool EventStoreLoad(EventStoreRecord *Record);
+// Update the event store with current data; NVS will only be written if data changed (see EventStoreHandle)
+extern void EventStoreUpdate(bool TxtValid, bool ReminderValid, bool Acknowledged, eventInfoStruct *EventData);
+// Write pending changes to NVS after the coalescing delay (or immediately if Flush is true); call in user_loop
+extern void EventStoreHandle(bool Flush);
+
+#endif // EVENTSTORE_H
@@ -0,0 +1,106 @@
+/*
+ *   ESP32 Rememberall
+ *   Fleet mode runtime configuration declarations
+ */
+#ifndef FLEET_CONFIG_H
+#define FLEET_CONFIG_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <PubSubClient.h>
+#include "mqtt-ota-config.h"
+#include "user-config.h"
+
+#ifdef FLEET_MODE
+//
+// Fleet Mode Configuration
+//
+// All devices run the same firmware image; device specific settings are loaded from NVS at boot.
+// The configuration is provisioned (retained) to FLEET_CFG_TOPTREE + MAC (12 hex digits, upper case), message format:
+// "TopTree;ClientName;WifiSleepDuration;LedBrightness;BeatsinCosy;BeatsinAggro;DisplayRotation"
+// e.g. "HB7/Indoor/VZ/Rememberall/;RmbrAll-VZ;1800;8;12;32;3"
+// If the received configuration differs from the stored one, it is written to NVS and the ESP restarts to apply it.
+// Once a configuration is stored, the topic is only subscribed after a power-on or reset (not on DeepSleep wakeups).
+// Unprovisioned devices use the compile time defaults and the client name FLEET_CLTNAME_PREFIX + last 6 MAC digits;
+// the topic is optional, so they do not wait for a configuration when connecting.
+// ATTN: Pins and LED count remain compile time settings!
+//
+#define FLEET_KEY "fleet"
+#define FLEET_VERSION 1 // increase when changing the FleetConfig layout
+#define FLEET_TOPTREE_SIZE 48
+#define FLEET_CLTNAME_SIZE 24
+#define FLEET_CLTNAME_PREFIX "RmbrAll-"
+#define FLEET_TOPIC_SIZE (FLEET_TOPTREE_SIZE + 32)
+
+struct FleetConfig
+{
+    uint16_t Version;                     // FLEET_VERSION
+    char TopTree[FLEET_TOPTREE_SIZE];     // MQTT topic tree (ends with "/")
+    char ClientName[FLEET_CLTNAME_SIZE];  // MQTT, OTA and DHCP client name
+    uint32_t WifiSleepDuration;           // see WIFI_SLEEP_DURATION
+    uint8_t LedBrightness;                // see FL_GLOBAL_BRIGHTNESS
+    uint8_t BeatsinCosy;                  // see FL_RING_BEATSIN_COSY
+    uint8_t BeatsinAggro;                 // see FL_RING_BEATSIN_AGGRO
+    uint8_t DisplayRotation;              // see D_LANDSCAPE_ROT
+};
+extern FleetConfig FleetCfg;
+extern char FleetCfgTopic[];
+extern char FleetCfgMsg[MQTT_RCV_BUF_SIZE];
+
+// Runtime settings
+#define CFG_WIFI_SLEEP_DURATION FleetCfg.WifiSleepDuration
+#define CFG_GLOBAL_BRIGHTNESS FleetCfg.LedBrightness
+#define CFG_BEATSIN_COSY FleetCfg.BeatsinCosy
+#define CFG_BEATSIN_AGGRO FleetCfg.BeatsinAggro
+#define CFG_LANDSCAPE_ROT FleetCfg.DisplayRotation
+
+// Load configuration from NVS (or defaults); call first in setup()
+extern void FleetConfigLoad();
+// Store a newly provisioned configuration and restart (call in main loop while connected)
+extern void FleetConfigHandle();
+// Replace the FLEET_TOPTREE_MARK of a topic with the configured topic tree; returns Topic or Buf
+extern const char *FleetTopic(const char *Topic, char *Buf, size_t BufLen);
+
+//
+// MQTT client resolving the runtime topic tree for all topics
+//
+class FleetMqttClient : public PubSubClient
+{
+public:
+    using PubSubClient::PubSubClient;
+    bool publish(const char *Topic, const char *Payload, bool Retained = false)
+    {
+        char Buf[FLEET_TOPIC_SIZE];
+        return PubSubClient::publish(FleetTopic(Topic, Buf, sizeof(Buf)), Payload, Retained);
+    }
+    bool publish(const char *Topic, const uint8_t *Payload, unsigned int Length, bool Retained = false)
+    {
+        char Buf[FLEET_TOPIC_SIZE];
+        return PubSubClient::publish(FleetTopic(Topic, Buf, sizeof(Buf)), Payload, Length, Retained);
+    }
+    bool beginPublish(const char *Topic, unsigned int Length, bool Retained)
+    {
+        char Buf[FLEET_TOPIC_SIZE];
+        return PubSubClient::beginPublish(FleetTopic(Topic, Buf, sizeof(Buf)), Length, Retained);
+    }
+    bool subscribe(const char *Topic, uint8_t Qos = 0)
+    {
+        char Buf[FLEET_TOPIC_SIZE];
+        return PubSubClient::subscribe(FleetTopic(Topic, Buf, sizeof(Buf)), Qos);
+    }
+    bool unsubscribe(const char *Topic)
+    {
+        char Buf[FLEET_TOPIC_SIZE];
+        return PubSubClient::unsubscribe(FleetTopic(Topic, Buf, sizeof(Buf)));
+    }
+};
+#else
+// Compile time settings
+#define CFG_WIFI_SLEEP_DURATION WIFI_SLEEP_DURATION
+#define CFG_GLOBAL_BRIGHTNESS FL_GLOBAL_BRIGHTNESS
+#define CFG_BEATSIN_COSY FL_RING_BEATSIN_COSY
+#define CFG_BEATSIN_AGGRO FL_RING_BEATSIN_AGGRO
+#define CFG_LANDSCAPE_ROT D_LANDSCAPE_ROT
+#endif // FLEET_MODE
+
+#endif // FLEET_CONFIG_H
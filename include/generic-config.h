@@ -18,13 +18,8 @@
 // Serial Output configuration
 //
 #define BAUD_RATE 115200
-#ifdef SERIAL_OUT
-#define DEBUG_PRINT(...) Serial.print(__VA_ARGS__)
-#define DEBUG_PRINTLN(...) Serial.println(__VA_ARGS__)
-#else
-#define DEBUG_PRINT(...)
-#define DEBUG_PRINTLN(...)
-#endif
+// Logging macros LOG_E/W/I/D (see logger.h)
+#include "logger.h"
 
 //
 // Handle #define dependencies
@@ -38,5 +33,45 @@
 #undef NTP_CLT // to avoid compiler warning
 #define NTP_CLT
 #endif
+#ifdef RTC_DRIFT_LEARNING
+#if !defined SLEEP_UNTIL && !defined E32_DEEP_SLEEP
+#undef RTC_DRIFT_LEARNING // nothing to learn without DeepSleep
+#else
+#undef KEEP_RTC_SLOWMEM // to avoid compiler warning
+#define KEEP_RTC_SLOWMEM // learned data is kept in RTC memory
+#endif
+#endif
+#ifdef DIAG_RING
+#undef KEEP_RTC_SLOWMEM // to avoid compiler warning
+#define KEEP_RTC_SLOWMEM // diagnostic records are kept in RTC memory
+#endif
+#ifdef WAKE_STUB
+#ifdef ESP32C6
+#undef WAKE_STUB // TODO for ESP32-C6
+#else
+#undef KEEP_RTC_SLOWMEM // to avoid compiler warning
+#define KEEP_RTC_SLOWMEM // wake stub data is kept in RTC memory
+#endif
+#endif
+#ifdef ENERGY_STATS
+#undef KEEP_RTC_SLOWMEM // to avoid compiler warning
+#define KEEP_RTC_SLOWMEM // statistics are kept in RTC memory
+#endif
+#ifdef ULP_MONITOR
+#if defined ESP32C6 || !defined READVCC
+#undef ULP_MONITOR // TODO for ESP32-C6; VBAT sampling requires READVCC
+#else
+#undef KEEP_RTC_SLOWMEM // to avoid compiler warning
+#define KEEP_RTC_SLOWMEM // ULP program and samples are kept in RTC memory
+#endif
+#endif
+#ifdef RTC_TIME_TRUST
+#if !defined SLEEP_UNTIL && !defined E32_DEEP_SLEEP
+#undef RTC_TIME_TRUST // RTC time is only trusted after DeepSleep
+#else
+#undef KEEP_RTC_SLOWMEM // to avoid compiler warning
+#define KEEP_RTC_SLOWMEM // last sync epoch is kept in RTC memory
+#endif
+#endif
 
 #endif // GENERIC_CONFIG_H
\ No newline at end of file
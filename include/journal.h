@@ -0,0 +1,53 @@
+/*
+ *   ESP32 Rememberall
+ *   User action journal declarations
+ */
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "mqtt-ota-config.h"
+#include "user-config.h"
+
+//
+// Journal Configuration
+//
+// User actions (button) are recorded with timestamp in a small ring buffer in NVS and published to Journal_topic
+// in one batch at the next MQTT connection, so an action does not require a radio session of its own.
+// The whole ring is published (retained) every time, each entry carries a sequence number (idempotency key)
+// which allows the feeder to skip entries it has already processed.
+#define JRN_KEY "journal"
+#define JRN_SIZE 6 // number of entries kept (ATTN: message must fit into the PubSubClient buffer!)
+
+// Journal actions
+#define JRN_ACK 'A'    // event acknowledged (double click)
+#define JRN_SNOOZE 'S' // reminder skipped (single click)
+
+struct JournalEntry
+{
+    uint32_t Seq;    // sequence number (0 = unused entry)
+    char Action;     // JRN_ACK / JRN_SNOOZE
+    time_t Epoch;    // time of the action
+    time_t Deadline; // deadline of the event the action refers to
+};
+
+struct JournalStruct
+{
+    uint32_t NextSeq;               // sequence number of the next entry
+    uint32_t SentSeq;               // highest sequence number published to the broker
+    JournalEntry Entries[JRN_SIZE]; // ring buffer, Entries[Seq % JRN_SIZE]
+};
+
+// Load journal from NVS (call in user_setup)
+extern void JournalLoad();
+// Add an action to the journal (written to NVS immediately)
+extern void JournalAdd(char Action, time_t Epoch, time_t Deadline);
+// Returns true if there are unpublished entries
+extern bool JournalPending();
+// Returns true if the journal contains an acknowledge for the event with the given deadline
+extern bool JournalHasAck(time_t Deadline);
+// Publish journal to Journal_topic (and "ack" to Status_topic if the current event has been acknowledged); returns true on success
+extern bool JournalReplay(time_t CurrentDeadline);
+
+#endif // JOURNAL_H
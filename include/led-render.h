@@ -0,0 +1,38 @@
+/*
+ *   ESP32 Rememberall
+ *   LED ring rendering stage declarations
+ */
+#ifndef LED_RENDER_H
+#define LED_RENDER_H
+
+#include <Arduino.h>
+#include "mqtt-ota-config.h"
+#include "user-config.h"
+
+#ifdef LED_RENDER
+//
+// LED ring rendering stage
+// The animation draws into LedRing in full 8 bit range. Each frame, every channel is mapped through a
+// precomputed LUT (gamma, white balance and global brightness) to a 8.8 fixed point output value. The integer part
+// is sent to the LEDs, the fraction (reduced to LED_DITHER_BITS) is accumulated per LED and channel and adds
+// one output step whenever it overflows, so the average over a few frames matches the 16 bit value.
+// Frames are paced at LED_RENDER_FPS: a steady cadence keeps the dither pattern from beating with the loop timing,
+// and the ring is not refreshed more often than needed. If the main loop is too slow to keep up, the animation advances
+// by the elapsed frame periods (see LedRenderFade) and dithering is off until frames are on time again, as a dither
+// cycle spread over slow frames would be visible as flicker. Per frame the cost is a table lookup, an add and a shift
+// per channel; the LUT (1.5kB RAM) is only rebuilt when the brightness changes.
+//
+// Output buffer to register with FastLED.addLeds (global brightness and FastLED dithering must be disabled)
+extern CRGB LedOut[FL_RING_NUM_LEDS];
+// Build the LUT for the given global brightness
+extern void LedRenderBegin(uint8_t Brightness);
+// Returns the number of frame periods elapsed since the last frame (max. 255), 0 if the next frame is not due yet;
+// if non-zero, the animation should advance by this many frames and LedRenderShow be called
+extern uint8_t LedRenderDue();
+// fadeToBlackBy amount equivalent to LED_RENDER_FADE applied Frames times
+extern uint8_t LedRenderFade(uint8_t Frames);
+// Map the frame in Src to LedOut and send it to the LED ring
+extern void LedRenderShow(const CRGB *Src);
+#endif // LED_RENDER
+
+#endif // LED_RENDER_H
@@ -0,0 +1,72 @@
+/*
+ *   ESP32 Template
+ *   Structured logger declarations
+ */
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <Arduino.h>
+
+//
+// Log levels
+//
+#define LOG_LVL_NONE 0
+#define LOG_LVL_ERROR 1
+#define LOG_LVL_WARN 2
+#define LOG_LVL_INFO 3
+#define LOG_LVL_DEBUG 4
+
+// Compile-time log level (override with -D LOG_LEVEL=x in platformio.ini)
+// defaults to LOG_LVL_DEBUG if a log sink is enabled (SERIAL_OUT or LOG_MQTT), else everything is compiled out
+#ifndef LOG_LEVEL
+#if defined SERIAL_OUT || defined LOG_MQTT
+#define LOG_LEVEL LOG_LVL_DEBUG
+#else
+#define LOG_LEVEL LOG_LVL_NONE
+#endif
+#endif
+
+//
+// Logger configuration
+//
+// Records are formatted into a fixed size ring buffer at the call site (no heap allocation);
+// a low priority task drains the ring to Serial. With LOG_MQTT, the ring is drained in the main loop instead
+// and records are additionally published to log_topic (PubSubClient must only be used from the main loop).
+// If the ring is full, new records are dropped and counted.
+#define LOG_RING_SIZE 16        // number of records in the ring buffer
+#define LOG_MSG_SIZE 96         // max. length of a log message including terminating null (longer messages are truncated)
+#define LOG_TASK_INTERVAL 50    // ms between Serial drain runs of the logger task
+#define LOG_TASK_STACK 2048     // stack size of the logger task
+#define LOG_FLUSH_MAX 64        // max. records written by LogFlush (bounds the time spent before DeepSleep)
+#define LOG_FLUSH_WAIT 20       // max. ms LogFlush waits for a busy logger task / producer
+#ifdef LOG_MQTT
+#define log_topic TOPTREE "Log" // MQTT topic for log records ("Millis;Level;Message", not retained)
+#endif
+
+//
+// Logging macros (printf-style format; format strings are literals and stay in flash)
+// Calls above LOG_LEVEL are removed at compile time, arguments are not evaluated
+//
+#define LOG_AT(Lvl, ...)              \
+    do                                \
+    {                                 \
+        if (LOG_LEVEL >= (Lvl))       \
+        {                             \
+            LogWrite((Lvl), __VA_ARGS__); \
+        }                             \
+    } while (0)
+#define LOG_E(...) LOG_AT(LOG_LVL_ERROR, __VA_ARGS__)
+#define LOG_W(...) LOG_AT(LOG_LVL_WARN, __VA_ARGS__)
+#define LOG_I(...) LOG_AT(LOG_LVL_INFO, __VA_ARGS__)
+#define LOG_D(...) LOG_AT(LOG_LVL_DEBUG, __VA_ARGS__)
+
+// Start logger (call in setup after Serial.begin)
+extern void LogSetup();
+// Format a record into the ring buffer; use LOG_x macros instead of calling directly
+extern void LogWrite(uint8_t Level, const char *Fmt, ...) __attribute__((format(printf, 2, 3)));
+// Drain the ring buffer (main loop with LOG_MQTT; records are published if Online is true)
+extern void LogHandle(bool Online);
+// Write all pending records to Serial (call before DeepSleep or restart)
+extern void LogFlush();
+
+#endif // LOGGER_H
@@ -0,0 +1,40 @@
+/*
+ *   ESP32 Rememberall
+ *   Content manifest declarations
+ */
+#ifndef MANIFEST_H
+#define MANIFEST_H
+
+#include <Arduino.h>
+#include "mqtt-ota-config.h"
+#include "user-config.h"
+
+#ifdef CONTENT_MANIFEST
+//
+// Content manifest
+// The Feeder publishes "Version;eventTxtHash;eventReminderHash" (hex, retained) to Manifest_topic along with the event topics.
+// Version is increased on every content change, hashes are FNV-1a (32 bit) of the topic messages.
+// eventTxt and eventReminder are deferred subscriptions: they will only be subscribed (and decoded) if the manifest
+// differs from the content decoded before. Hashes of the decoded content are kept in RTC memory.
+//
+#define MNF_TXT 0
+#define MNF_REMINDER 1
+#define MNF_TOPIC_CNT 2
+
+struct ContentManifest
+{
+    uint32_t Version;              // content version
+    uint32_t Hash[MNF_TOPIC_CNT];  // FNV-1a of the topic messages
+};
+
+// Decode manifest message; returns false on invalid input
+extern bool ManifestDecode(const char *Msg, ContentManifest *Manifest);
+// Returns true if the content of the given topic (MNF_*) has already been decoded
+extern bool ManifestCurrent(ContentManifest *Manifest, int Topic);
+// Record a decoded message of the given topic (MNF_*)
+extern void ManifestDecoded(int Topic, const char *Msg);
+// Returns true if the given message has already been decoded (e.g. received without asking for it)
+extern bool ManifestKnown(int Topic, const char *Msg);
+#endif // CONTENT_MANIFEST
+
+#endif // MANIFEST_H
@@ -15,13 +15,19 @@
 // MQTT Broker Settings
 //
 // MQTT Client name used to subscribe to topics
+#ifdef FLEET_MODE
+#define MQTT_CLTNAME FleetCfg.ClientName // loaded at runtime (see fleet-config.h)
+#else
 #define MQTT_CLTNAME TEXTIFY(CLTNAME)
+#endif
 // Maximum connection attempts to MQTT broker before going to sleep
 #define MAXCONNATTEMPTS 3
 #ifdef WAIT_FOR_SUBSCRIPTIONS
 // Maximum retry attempts to receive messages for all subscribed topics; ESP will continue according to NET_OUTAGE setting afterwards
 // default setting of 300 should try for ~30sec to fetch messages for all subscribed topics
 #define MAX_TOP_RCV_ATTEMPTS 300
+// Additional attempts (100ms each) to fetch retained messages of optional topics once all other topics have been received
+#define OPT_TOP_RCV_ATTEMPTS 3
 #endif
 // Message buffer for incoming Data from MQTT subscriptions
 // increase if you receive larger messages for subscribed topics
@@ -29,11 +35,35 @@
 #ifndef MQTT_MAX_MSG_SIZE
 #define MQTT_MAX_MSG_SIZE 20
 #endif
-extern char message_buff[MQTT_MAX_MSG_SIZE];
+// OTA pull requests (see ota-pull.h) contain an URL and need a larger buffer
+#ifdef OTA_PULL
+#define OTA_PULL_MSG_SIZE 256
+#endif
+// Fleet mode configuration messages (see fleet-config.h)
+#ifdef FLEET_MODE
+#define FLEET_CFG_MSG_SIZE 128
+#endif
+#if defined OTA_PULL && OTA_PULL_MSG_SIZE > MQTT_MAX_MSG_SIZE
+#define MQTT_RCV_BUF_SIZE OTA_PULL_MSG_SIZE
+#elif defined FLEET_MODE && FLEET_CFG_MSG_SIZE > MQTT_MAX_MSG_SIZE
+#define MQTT_RCV_BUF_SIZE FLEET_CFG_MSG_SIZE
+#else
+#define MQTT_RCV_BUF_SIZE MQTT_MAX_MSG_SIZE
+#endif
+extern char message_buff[MQTT_RCV_BUF_SIZE];
 
 // MQTT Topic Tree prepended to all topics
 // ATTN: Must end with "/"!
 // alternatively defined in user-config.h
+#ifdef FLEET_MODE
+// Topic tree is loaded at runtime: topics start with a placeholder which is replaced by FleetMqttClient (see fleet-config.h)
+#undef TOPTREE // to avoid compiler warning
+#define FLEET_TOPTREE_MARK "~/"
+#define TOPTREE FLEET_TOPTREE_MARK
+// Topic tree of unprovisioned devices (followed by the client name) and of the configuration topics (followed by the MAC)
+#define FLEET_DEF_TOPTREE "HB7/Fleet/Rememberall/"
+#define FLEET_CFG_TOPTREE FLEET_DEF_TOPTREE "Config/"
+#endif
 #ifndef TOPTREE
 #define TOPTREE "HB7/Test/"
 #endif
@@ -50,7 +80,11 @@ extern char message_buff[MQTT_MAX_MSG_SIZE];
 // OTA-Update MQTT Topics and corresponding global vars
 //
 // OTA Client Name
+#ifdef FLEET_MODE
+#define OTA_CLTNAME FleetCfg.ClientName
+#else
 #define OTA_CLTNAME TEXTIFY(CLTNAME)
+#endif
 // OTA Update specific vars
 // to start an OTA update on the ESP, you will need to set ota_topic to "on"
 // (don't forget to add the "retain" flag, especially if you want a sleeping ESP to enter flash mode at next boot)
@@ -61,12 +95,31 @@ extern bool OTAupdate;
 #define UPDATEREQ "update_requested"  // Waiting for binary upload
 #define UPDATECANC "update_cancelled" // Update cancelled by user (OTAupdate reset to off befor upload)
 #define UPDATEOK "update_success"     // Update successful
+#define UPDATETIMEOUT "update_timeout" // No upload within OTA_PUSH_TIMEOUT, normal operation resumed
 // An additional "external flag" is required to "remind" a freshly running sketch that it was just OTA-flashed..
 // during an OTA update, PubSubClient functions do not ru (or cannot access the network)
 // so this flag will be set to ON when actually waiting for the OTA update to start
 // it will be reset if OtaInProgress and OTAupdate are true (in that case, ESP has most probably just been successfully flashed)
 #define otaInProgress_topic TOPTREE "OTAinProgress" // local BOOL, MQTT either "on" or "off"
 extern bool OtaInProgress;
+// Timeouts for OTA updates (ms)
+#define OTA_TOPIC_TIMEOUT 30000  // max. time to wait for all MQTT topics before handling an OTA request
+#define OTA_PUSH_TIMEOUT 300000  // max. time to wait for an espota upload per connection
+#define OTA_PUSH_MAX_ATTEMPTS 3  // connections waiting for an upload before OTAupdate is reset to "off"
+#ifdef OTA_PULL
+// OTA pull update (HTTP download of the image, see ota-pull.h)
+#define otaPull_topic TOPTREE "OTApull" // "Version|HMAC|URL" (retained)
+extern char OtaPullMsg[MQTT_RCV_BUF_SIZE];
+#define UPDATEPULL "update_pull_started"    // Download of the image started
+#define UPDATEPULLFAIL "update_pull_failed" // Download or verification failed (see log)
+#define OTA_PULL_CHUNK 1024                // bytes per flash write
+#define OTA_PULL_CHUNKS_PER_LOOP 4         // max. chunks written per main loop iteration
+#define OTA_PULL_CONNECT_TIMEOUT 3000      // HTTP connect timeout
+#define OTA_PULL_RESPONSE_TIMEOUT 3000     // max. time to wait for the HTTP response headers (GET blocks the main loop)
+#define OTA_PULL_STALL_TIMEOUT 15000       // abort if no data has been received for this time
+#define OTA_PULL_MAX_DURATION 300000       // abort if the download takes longer
+#define OTA_PULL_MAX_RETRIES 3             // stop retrying a failing version after this amount of attempts
+#endif
 // Internal helpers
 extern bool SentUpdateRequested;
 extern bool OtaIPsetBySketch;
@@ -78,7 +131,7 @@ extern bool SentOtaIPtrue;
 struct MqttSubCfg
 {
     const char *Topic; // Topic to subscribe to
-    int Type;          // Type of message data received: 0=bool (message "on/off"); 1=int; 2=float; 3=time_t; 4=string
+    int Type;          // Type of message data received: 0=bool (message "on/off"); 1=int; 2=float; 3=time_t; 4=string; 5=long string
     bool Subscribed;   // true if successfully subscribed to topic
     uint32_t MsgRcvd;  // true if a message has been received for topic
     union              // Pointer to Variable which should be updated with the decoded message (only one applies acc. to "Type")
@@ -89,6 +142,8 @@ struct MqttSubCfg
         long *TimePtr;
         char *stringPtr;
     };
+    bool Deferred;     // true if the topic should not be subscribed at connect, but on demand (see MqttSubscribe)
+    bool Optional;     // true if the topic is subscribed at connect, but a (retained) message is not required (see MqttTopicsMissing)
 };
 
 extern const int SubscribedTopicCnt; // Number of elements in MqttSubscriptions array (define in mqtt-subscriptions.cpp)
@@ -116,6 +171,35 @@ extern time_t SleepUntilEpoch; // stores time until ESP will sleep
 // Topic where VCC will be published
 #define vcc_topic TOPTREE "Vbat"
 extern float VCC;
+#ifdef ULP_MONITOR
+// Topic where VBAT samples taken during DeepSleep will be published (see ulp-monitor.h)
+#define vcc_hist_topic TOPTREE "VbatHistory"
+#endif
+#endif
+
+//
+// Runtime memory report Topic
+//
+#ifdef MEM_REPORT
+// Topic where heap statistics will be published (every MQTT_PUB_INTERVAL)
+// Message format: "FreeHeap;MinFreeHeap;LargestFreeBlock;Fragmentation_in_percent;LoopStackFree" (bytes)
+#define mem_topic TOPTREE "MemStats"
+#endif
+
+//
+// Energy accounting Topic (see energy.h)
+//
+#ifdef ENERGY_STATS
+// Message format: "Day_epoch_in_hex;mAh_per_state;...;mAh_total;Projected_runtime_in_days" (retained)
+#define energy_topic TOPTREE "Energy"
+#endif
+
+//
+// Remote diagnostics Topics (see diag.h)
+//
+#ifdef DIAG_RING
+#define diag_req_topic TOPTREE "DiagRequest" // local BOOL, MQTT either "on" or "off" (retained, reset to "off" after publishing)
+#define diag_topic TOPTREE "Diag"            // diagnostic records "Type;Code;Value;Epoch_in_hex|..." (retained)
 #endif
 
 #endif // MQTT_OTA_CONFIG_H
\ No newline at end of file
@@ -0,0 +1,37 @@
+/*
+ *   ESP32 Template
+ *   OTA image decoder declarations (compressed images and deltas)
+ */
+#ifndef OTA_DECODE_H
+#define OTA_DECODE_H
+
+#include <Arduino.h>
+#include "mqtt-ota-config.h"
+
+#ifdef OTA_PULL
+//
+// OTA image decoder
+// Downloaded OTA data is detected by its first bytes:
+// - 0xE9: plain firmware image
+// - 0x78: zlib compressed data (containing a firmware image or a delta); inflated with the ROM miniz decompressor
+// - "RDIF": delta against the running firmware (see scripts/ota-pack.py)
+// Everything is decoded in a streaming fashion straight into the OTA partition. RAM usage is bounded by
+// the inflate dictionary (32kB) and the decompressor state (~11kB), both allocated only while updating.
+//
+#define OTA_IMAGE_MAGIC 0xE9     // first byte of an ESP32 firmware image
+#define OTA_DELTA_MAGIC "RDIF"
+#define OTA_DELTA_HDR_SIZE 24 // magic (4), base FIRMWARE_VERSION (16, null padded), image size (4)
+#define OTA_DELTA_OP_COPY 1   // op (1), offset in running image (4), length (4)
+#define OTA_DELTA_OP_ADD 2    // op (1), length (4), literal data
+
+// Prepare the OTA partition for a new image
+extern bool OtaDecodeBegin();
+// Decode downloaded data into the OTA partition
+extern bool OtaDecodeWrite(const uint8_t *Data, size_t Len);
+// Verify the decoded image and activate it
+extern bool OtaDecodeEnd();
+// Abort decoding and release all buffers
+extern void OtaDecodeAbort();
+#endif // OTA_PULL
+
+#endif // OTA_DECODE_H
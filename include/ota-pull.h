@@ -0,0 +1,31 @@
+/*
+ *   ESP32 Template
+ *   OTA pull update declarations
+ */
+#ifndef OTA_PULL_H
+#define OTA_PULL_H
+
+#include <Arduino.h>
+#include "mqtt-ota-config.h"
+
+#ifdef OTA_PULL
+//
+// OTA pull update
+// Publish "Version|HMAC|URL" (retained) to otaPull_topic to let the ESP download the image via HTTP:
+// - Version: firmware version of the image; the update is skipped if it matches FIRMWARE_VERSION
+// - HMAC: HMAC-SHA256 of the downloaded file (hex), keyed with OTA_PWD
+// - URL: http URL of the image (server must send Content-Length); authenticity is ensured by the HMAC
+// The file may be a plain image, a zlib compressed image or a (compressed) delta against the running firmware,
+// see ota-decode.h and scripts/ota-pack.py.
+// The image is streamed into the inactive OTA partition in chunks from the main loop, so user_loop keeps running.
+// It is only activated if the HMAC matches; the ESP restarts afterwards.
+//
+
+// Handle OTA pull requests (call in main loop while connected)
+extern void OtaPullHandle();
+#endif // OTA_PULL
+
+// Returns true while a download is in progress (don't disconnect WiFi / sleep); always false without OTA_PULL
+extern bool OtaPullActive();
+
+#endif // OTA_PULL_H
@@ -0,0 +1,278 @@
+/*
+ *   ESP32 Rememberall
+ *   Codec of the event topic payloads (header only)
+ */
+#ifndef PAYLOAD_CODEC_H
+#define PAYLOAD_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+//
+// Event payload codec
+// Shared by the firmware, the host simulator and the host CLI (scripts/payload-cli.cpp), so it depends on
+// nothing but the C library. Decoding does not modify or copy the message: text lines are returned as pointer
+// and length into it. Encoding writes into the given buffer. Nothing is allocated.
+//
+// eventTxt:      "LineCount[;IconID]|ColorLine1;TextLine1|ColorLine2;TextLine2|..."
+//                LineCount 1..PAYLOAD_MAX_LINES, IconID and colors decimal, texts must not contain '|' or ';'
+// eventReminder: "Deadline|CosyReminder|AgressiveReminder|0xRRGGBB"
+//                epoch time stamps in hex (optional 0x prefix), LED ring color in hex
+//
+#define PAYLOAD_MAX_LINES 3
+#define PAYLOAD_ERR_LINECNT 0 // PayloadTxt.ErrLine: LineCount invalid or not matching the lines in the message
+
+struct PayloadTxt
+{
+    uint8_t LineCnt;                      // number of text lines
+    uint8_t IconId;                       // 0 = no icon
+    uint16_t LineCol[PAYLOAD_MAX_LINES];  // text color of each line
+    const char *Text[PAYLOAD_MAX_LINES];  // text of each line (not null terminated when decoded)
+    uint8_t TextLen[PAYLOAD_MAX_LINES];
+    uint8_t ErrLine;                      // decoding error: PAYLOAD_ERR_LINECNT or number of the invalid line
+};
+
+struct PayloadReminder
+{
+    int64_t Deadline;          // event deadline
+    int64_t CosyReminder;      // start of the cosy reminder period
+    int64_t AgressiveReminder; // start of the agressive reminder period
+    uint32_t LedColor;         // 0xRRGGBB
+};
+
+// Parse an unsigned decimal number not larger than Max
+inline const char *PayloadParseDec(const char *P, uint32_t Max, uint32_t *Value)
+{
+    uint32_t V = 0;
+    const char *Start = P;
+    while (*P >= '0' && *P <= '9')
+    {
+        V = V * 10 + (uint32_t)(*P++ - '0');
+        if (V > Max)
+        {
+            return NULL;
+        }
+    }
+    if (P == Start)
+    {
+        return NULL;
+    }
+    *Value = V;
+    return P;
+}
+
+// Parse a hex number with optional 0x prefix of at most MaxDigits digits
+inline const char *PayloadParseHex(const char *P, int MaxDigits, uint64_t *Value)
+{
+    uint64_t V = 0;
+    int Digits = 0;
+    if (P[0] == '0' && (P[1] == 'x' || P[1] == 'X'))
+    {
+        P += 2;
+    }
+    for (;; P++)
+    {
+        uint8_t Nibble;
+        if (*P >= '0' && *P <= '9')
+            Nibble = (uint8_t)(*P - '0');
+        else if (*P >= 'a' && *P <= 'f')
+            Nibble = (uint8_t)(*P - 'a' + 10);
+        else if (*P >= 'A' && *P <= 'F')
+            Nibble = (uint8_t)(*P - 'A' + 10);
+        else
+            break;
+        if (++Digits > MaxDigits)
+        {
+            return NULL;
+        }
+        V = (V << 4) | Nibble;
+    }
+    if (Digits == 0)
+    {
+        return NULL;
+    }
+    *Value = V;
+    return P;
+}
+
+// Decode eventTxt; on failure Txt->ErrLine tells what was wrong
+inline bool PayloadDecodeTxt(const char *Msg, PayloadTxt *Txt)
+{
+    uint32_t Value;
+    const char *P = PayloadParseDec(Msg, PAYLOAD_MAX_LINES, &Value);
+    Txt->ErrLine = PAYLOAD_ERR_LINECNT;
+    if (P == NULL || Value == 0)
+    {
+        return false;
+    }
+    Txt->LineCnt = (uint8_t)Value;
+    Txt->IconId = 0;
+    if (*P == ';')
+    {
+        P = PayloadParseDec(P + 1, 255, &Value);
+        if (P == NULL)
+        {
+            return false;
+        }
+        Txt->IconId = (uint8_t)Value;
+    }
+    for (int i = 0; i < Txt->LineCnt; i++)
+    {
+        if (*P != '|')
+        {
+            return false;
+        }
+        Txt->ErrLine = (uint8_t)(i + 1);
+        P = PayloadParseDec(P + 1, 0xFFFF, &Value);
+        if (P == NULL || *P != ';')
+        {
+            return false;
+        }
+        Txt->LineCol[i] = (uint16_t)Value;
+        Txt->Text[i] = ++P;
+        while (*P != '\0' && *P != '|' && *P != ';')
+        {
+            P++;
+        }
+        if (P == Txt->Text[i] || *P == ';' || P - Txt->Text[i] > 255)
+        {
+            return false;
+        }
+        Txt->TextLen[i] = (uint8_t)(P - Txt->Text[i]);
+    }
+    // more lines than announced
+    Txt->ErrLine = PAYLOAD_ERR_LINECNT;
+    return *P == '\0';
+}
+
+// Decode eventReminder
+inline bool PayloadDecodeReminder(const char *Msg, PayloadReminder *Reminder)
+{
+    int64_t *Stamps[3] = {&Reminder->Deadline, &Reminder->CosyReminder, &Reminder->AgressiveReminder};
+    uint64_t Value;
+    const char *P = Msg;
+    for (int i = 0; i < 3; i++)
+    {
+        P = PayloadParseHex(P, 15, &Value);
+        if (P == NULL || *P != '|')
+        {
+            return false;
+        }
+        *Stamps[i] = (int64_t)Value;
+        P++;
+    }
+    P = PayloadParseHex(P, 8, &Value);
+    if (P == NULL || *P != '\0')
+    {
+        return false;
+    }
+    Reminder->LedColor = (uint32_t)Value;
+    return true;
+}
+
+// Append helpers for the encoders; return false if Buf is full
+inline bool PayloadPutChar(char *Buf, size_t Size, size_t *Len, char C)
+{
+    if (*Len + 1 >= Size)
+    {
+        return false;
+    }
+    Buf[(*Len)++] = C;
+    return true;
+}
+
+inline bool PayloadPutDec(char *Buf, size_t Size, size_t *Len, uint32_t Value)
+{
+    char Digits[10];
+    int Cnt = 0;
+    do
+    {
+        Digits[Cnt++] = (char)('0' + Value % 10);
+        Value /= 10;
+    } while (Value > 0);
+    while (Cnt > 0)
+    {
+        if (!PayloadPutChar(Buf, Size, Len, Digits[--Cnt]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline bool PayloadPutHex(char *Buf, size_t Size, size_t *Len, uint64_t Value, int MinDigits, bool Upper)
+{
+    const char *Hex = Upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    int Digits = 1;
+    while (Digits < 16 && (Value >> (4 * Digits)) != 0)
+    {
+        Digits++;
+    }
+    if (Digits < MinDigits)
+    {
+        Digits = MinDigits;
+    }
+    while (Digits > 0)
+    {
+        if (!PayloadPutChar(Buf, Size, Len, Hex[(Value >> (4 * --Digits)) & 0xF]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Encode eventTxt (Text[i] with TextLen[i] characters); returns the message length or 0 if invalid or Buf too small
+inline size_t PayloadEncodeTxt(const PayloadTxt *Txt, char *Buf, size_t Size)
+{
+    size_t Len = 0;
+    if (Txt->LineCnt == 0 || Txt->LineCnt > PAYLOAD_MAX_LINES || !PayloadPutDec(Buf, Size, &Len, Txt->LineCnt))
+    {
+        return 0;
+    }
+    if (Txt->IconId != 0 && !(PayloadPutChar(Buf, Size, &Len, ';') && PayloadPutDec(Buf, Size, &Len, Txt->IconId)))
+    {
+        return 0;
+    }
+    for (int i = 0; i < Txt->LineCnt; i++)
+    {
+        if (Txt->TextLen[i] == 0 || !PayloadPutChar(Buf, Size, &Len, '|') || !PayloadPutDec(Buf, Size, &Len, Txt->LineCol[i]) ||
+            !PayloadPutChar(Buf, Size, &Len, ';'))
+        {
+            return 0;
+        }
+        for (int c = 0; c < Txt->TextLen[i]; c++)
+        {
+            char C = Txt->Text[i][c];
+            if (C == '\0' || C == '|' || C == ';' || !PayloadPutChar(Buf, Size, &Len, C))
+            {
+                return 0;
+            }
+        }
+    }
+    Buf[Len] = '\0';
+    return Len;
+}
+
+// Encode eventReminder like the Feeder script; returns the message length or 0 if invalid or Buf too small
+inline size_t PayloadEncodeReminder(const PayloadReminder *Reminder, char *Buf, size_t Size)
+{
+    const int64_t Stamps[3] = {Reminder->Deadline, Reminder->CosyReminder, Reminder->AgressiveReminder};
+    size_t Len = 0;
+    for (int i = 0; i < 3; i++)
+    {
+        if (Stamps[i] < 0 || !PayloadPutHex(Buf, Size, &Len, (uint64_t)Stamps[i], 1, false) || !PayloadPutChar(Buf, Size, &Len, '|'))
+        {
+            return 0;
+        }
+    }
+    if (Reminder->LedColor > 0xFFFFFF || !PayloadPutChar(Buf, Size, &Len, '0') || !PayloadPutChar(Buf, Size, &Len, 'x') ||
+        !PayloadPutHex(Buf, Size, &Len, Reminder->LedColor, 6, true))
+    {
+        return 0;
+    }
+    Buf[Len] = '\0';
+    return Len;
+}
+
+#endif // PAYLOAD_CODEC_H
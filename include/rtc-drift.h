@@ -0,0 +1,40 @@
+/*
+ *   ESP32 Template
+ *   RTC slow clock drift learning declarations
+ */
+#ifndef RTC_DRIFT_H
+#define RTC_DRIFT_H
+
+#include <Arduino.h>
+#include "time-config.h"
+
+#ifdef RTC_DRIFT_LEARNING
+//
+// Learned RTC slow clock correction (replaces the static CLK_CORR_FACTOR)
+// Model: CorrFactor = Theta[0] + Theta[1] * (Temperature - DRIFT_TEMP_REF)
+// Estimate and pending sleep sample are kept in RTC memory (requires KEEP_RTC_SLOWMEM)
+//
+struct RtcDriftState
+{
+    float Theta[2];      // model parameters
+    float P[2][2];       // covariance of the estimate
+    uint32_t Samples;    // number of samples learned
+    bool SamplePending;  // sleep data below is waiting for NTP sync after wakeup
+    time_t SleepStart;   // epoch when entering DeepSleep
+    uint32_t SleepCmd;   // sleep time (seconds) passed to the RTC timer
+    float SleepFactor;   // correction factor applied to the RTC calibration during the sleep
+    float Residual;      // decaying maximum of the relative prediction error
+};
+
+// Returns correction factor for the RTC calibration at boot (call in hardware_setup)
+extern float DriftBootFactor();
+// Returns the corrected sleep time in µs for the desired sleep duration and records the sample data
+// ATTN: call right before entering DeepSleep
+extern uint64_t DriftPrepareSleep(uint32_t Seconds);
+// Learn from the last sleep after the first NTP sync (call in main loop)
+extern void DriftLearn();
+// Relative error bound of the learned clock correction
+extern float DriftErrorBound();
+#endif // RTC_DRIFT_LEARNING
+
+#endif // RTC_DRIFT_H
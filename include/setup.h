@@ -16,6 +16,15 @@
 #include "macro-handling.h"
 #include "user-config.h"
 #include "time-config.h"
+#include "rtc-drift.h"
+#include "time-trust.h"
+#include "sysclock.h"
+#include "diag.h"
+#include "ota-pull.h"
+#include "fleet-config.h"
+#include "wake-stub.h"
+#include "ulp-monitor.h"
+#include "energy.h"
 
 
 // Declare setup functions
@@ -29,6 +38,10 @@ extern void ntp_setup();
 
 // Declare global objects
 extern WiFiClient WiFiClt;
+#ifdef FLEET_MODE
+extern FleetMqttClient mqttClt;
+#else
 extern PubSubClient mqttClt;
+#endif
 
 #endif // SETUP_H
\ No newline at end of file
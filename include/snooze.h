@@ -0,0 +1,19 @@
+/*
+ *   ESP32 Rememberall
+ *   Snooze (skip reminder) declarations
+ */
+#ifndef SNOOZE_H
+#define SNOOZE_H
+
+#include <Arduino.h>
+#include "mqtt-ota-config.h"
+#include "user-config.h"
+#include "common-functions.h"
+
+// Calculate snooze duration in seconds for the given event according to the snooze policy (see user-config.h)
+// Pass Active = false if there's no active reminder (or no valid time), BUT_SLEEP_DURATION will be returned
+extern uint32_t SnoozeDuration(eventInfoStruct *EventData, time_t Now, bool Active);
+// Enter DeepSleep for the given amount of seconds; a button press will also wake up the ESP
+extern void SnoozeSleep(uint32_t Seconds);
+
+#endif // SNOOZE_H
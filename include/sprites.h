@@ -0,0 +1,39 @@
+/*
+ *   ESP32 Rememberall
+ *   Event icon (sprite) declarations
+ */
+#ifndef SPRITES_H
+#define SPRITES_H
+
+#include <Arduino.h>
+
+//
+// Icon IDs as sent in the eventTxt message (first token: "LineCount;IconID")
+// ATTN: keep in sync with the Sprites array in sprites.cpp and the Feeder script!
+//
+#define ICON_NONE 0
+#define ICON_TRASH 1
+#define ICON_SPORT 2
+#define ICON_CAKE 3
+#define ICON_HEALTH 4
+
+//
+// Sprite definition
+// Bitmaps are stored in flash in Adafruit GFX bitmap format (row-major, MSB first, rows padded to full bytes)
+// 3-color ePaper uses 2 planes; a plane may be NULL if the icon has no pixels of this color
+//
+struct SpriteCfg
+{
+    uint8_t Width;             // Width in pixels
+    uint8_t Height;            // Height in pixels
+    const uint8_t *BlackPlane; // black pixels (bit set = black)
+    const uint8_t *RedPlane;   // red pixels (bit set = red)
+};
+
+extern const int SpriteCnt; // Number of elements in Sprites array (including ICON_NONE)
+extern const SpriteCfg Sprites[];
+
+// Returns sprite for given IconID or NULL if ICON_NONE / unknown
+extern const SpriteCfg *GetSprite(uint8_t IconId);
+
+#endif // SPRITES_H
@@ -0,0 +1,32 @@
+/*
+ *   ESP32 Template
+ *   System clock service declarations
+ */
+#ifndef SYSCLOCK_H
+#define SYSCLOCK_H
+
+#include <Arduino.h>
+#include "esp_timer.h"
+#include "time-config.h"
+
+#ifdef NTP_CLT
+//
+// System clock service
+// Caches epoch and local time (TimeInfo is only recalculated when the second changes) and tracks time validity.
+// If the system time leaves the plausibility window (CLOCK_MIN_EPOCH..CLOCK_MAX_EPOCH) after it has been valid,
+// time continues from the last plausible value based on the monotonic esp_timer.
+//
+
+// Refresh cached time (call once per main loop)
+extern void ClockUpdate();
+// Cached epoch time of the last ClockUpdate
+extern time_t ClockNow();
+// Cached local time of the last ClockUpdate
+extern const struct tm *ClockTimeInfo();
+// Returns true if the time is valid (NTP synced or trusted RTC time, see time-trust.h)
+extern bool ClockValid();
+// Set time validity (NTP sync callback and time-trust)
+extern void ClockSetValid(bool Valid);
+#endif // NTP_CLT
+
+#endif // SYSCLOCK_H
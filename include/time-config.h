@@ -40,18 +40,27 @@
 // Constructor for NTP sync callback function
 extern void NTP_Synced_Callback(struct timeval *t);
 
-// Global var increased on each time sync (set in NTP_Synced_Callback)
+// Plausibility window for the system time (see sysclock.h)
+#define CLOCK_MIN_EPOCH 1704067200 // 2024-01-01
+#define CLOCK_MAX_EPOCH 4102444800 // 2100-01-01
+
+// Global var increased on each time sync in this session (set in NTP_Synced_Callback)
+// ATTN: use ClockValid() (sysclock.h) to check if local time is valid
 extern unsigned int NTPSyncCounter;
-// Global struct containing system time info
-extern struct tm TimeInfo;
-// Global var containing system epoch time
-extern time_t EpochTime;
 // Configuration vars
 extern const char* NTPServer1;
 #ifdef NTPSRV_2
 extern const char* NTPServer2;
 #endif
 extern const char* time_zone;
+
+#ifdef RTC_TIME_TRUST
+// Trust RTC time after DeepSleep without waiting for NTP sync (see time-trust.h)
+#define TRUST_MAX_ERROR 60       // max. estimated time error in seconds to trust the RTC time after wakeup
+#define TRUST_RESYNC_ERROR 20    // NTP must sync before going to sleep again if the estimated error exceeds this (seconds)
+#define TRUST_SYNC_ERROR 1       // time error right after NTP sync in seconds
+#define TRUST_DRIFT_BOUND 0.02f  // worst case RTC drift (150kHz oscillator, without RTC_DRIFT_LEARNING)
+#endif
 #endif //NTP_CLT
 
 //
@@ -60,7 +69,7 @@ extern const char* time_zone;
 #if defined SLEEP_UNTIL || defined E32_DEEP_SLEEP
 // Correction factor for 150kHz / 8Mhz oscillator to compensate clock skew during ESP sleep
 // the default 150kHz oscillator is highly inaccurate and temperature-unstable, be aware that correction probably won't work well!
-// TODO: automatically re-calculate factor after sleep and store in RTC_SLOWMEM
+// If RTC_DRIFT_LEARNING is enabled (platformio.ini), this is only used as initial value for the learned factor
 #ifdef SLEEP_RTC_CLK_8M
 #define CLK_CORR_FACTOR 1.003170777577f
 #else
@@ -76,6 +85,21 @@ extern const char* time_zone;
 // ESP sleeps too long, factor needs to be increased
 // ATTN: MEASURE_SLEEP_CLOCK_SKEW requires SLEEP_UNTIL option!
 //#define MEASURE_SLEEP_CLOCK_SKEW
+
+#ifdef RTC_DRIFT_LEARNING
+// Automatic learning of the correction factor (see rtc-drift.h)
+// After each timer wakeup, the first NTP sync delivers the actual sleep duration which is used to update
+// a recursive least squares estimate of the correction factor and its dependency on the chip temperature
+#define DRIFT_TEMP_REF 25.0f      // reference temperature (°C) of the temperature model
+#define DRIFT_MIN_SLEEP 900       // only learn from sleeps of at least this amount of seconds (NTP resolution)
+#define DRIFT_MAX_DEVIATION 0.05f // discard samples deviating more than 5% from the current estimate (time jumps)
+#define DRIFT_FORGET 0.95f        // RLS forgetting factor (lower values adopt faster to changes)
+#define DRIFT_P_INIT 0.01f        // initial covariance of the estimate
+#define DRIFT_FACTOR_MIN 0.9f     // limits for the resulting correction factor
+#define DRIFT_FACTOR_MAX 1.1f
+#define DRIFT_MIN_SAMPLES 3       // number of samples required before the learned drift bound is used
+#define DRIFT_BOUND_MIN 0.001f    // lower limit of the learned drift bound
+#endif
 #endif
 
 #endif // TIME_CONFIG_H
\ No newline at end of file
@@ -0,0 +1,31 @@
+/*
+ *   ESP32 Template
+ *   RTC time validity declarations
+ */
+#ifndef TIME_TRUST_H
+#define TIME_TRUST_H
+
+#include <Arduino.h>
+#include "time-config.h"
+
+#ifdef NTP_CLT
+//
+// Time validity model
+// The epoch of the last NTP sync is kept in RTC memory; after DeepSleep wakeup or a reset that keeps the RTC running
+// (ESP.restart, panic, watchdog, brownout), the time error is estimated from the time elapsed since then and the RTC
+// drift bound. If the estimated error is small enough,
+// the RTC time is trusted immediately (ClockValid) and NTP resyncs in the background.
+// Without RTC_TIME_TRUST, time is only valid after NTP sync.
+//
+
+// Check if RTC time can be trusted after wakeup or reset (call in setup right after hardware_setup)
+extern void TimeTrustBoot();
+// Record NTP sync (called in NTP_Synced_Callback)
+extern void TimeTrustSynced(time_t SyncEpoch);
+// Estimated error of the current system time in seconds
+extern float TimeErrorEstimate();
+// Returns true if NTP should sync before the device may go to sleep again
+extern bool TimeResyncDue();
+#endif // NTP_CLT
+
+#endif // TIME_TRUST_H
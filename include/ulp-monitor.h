@@ -0,0 +1,49 @@
+/*
+ *   ESP32 Rememberall
+ *   ULP battery and button monitor declarations
+ */
+#ifndef ULP_MONITOR_H
+#define ULP_MONITOR_H
+
+#include <Arduino.h>
+#include "mqtt-ota-config.h"
+#include "user-config.h"
+
+#ifdef ULP_MONITOR
+//
+// ULP battery and button monitor
+// While the main CPU is in DeepSleep, the ULP coprocessor wakes up every ULP_PERIOD_MS to
+// - debounce BUTTON_GPIO (active low): the main CPU is woken up after ULP_BTN_DEBOUNCE consecutive low samples
+// - sample VBAT_ADC_PIN every ULP_VBAT_INTERVAL seconds into a ring buffer in RTC slow memory;
+//   the main CPU is woken up if VBAT drops below ULP_VBAT_LOW (once, until VBAT recovers)
+// The ULP is stopped while the main CPU is awake (ADC is used by READVCC). Samples are published as
+// "Epoch_of_newest_sample_in_hex;Interval_in_seconds;mV,mV,..." (oldest first, retained) to vcc_hist_topic.
+// The ULP-FSM is programmed with the ulp.h instruction macros, as the Arduino framework does not build ULP binaries.
+// Program and data need to fit into the ULP reserved RTC slow memory (CONFIG_ULP_COPROC_RESERVE_MEM, 512 bytes).
+//
+#define ULP_PERIOD_MS 20        // ULP wakeup period (button sampling)
+#define ULP_BTN_DEBOUNCE 3      // consecutive low button samples required for a wakeup (60ms)
+#define ULP_VBAT_INTERVAL 900   // seconds between VBAT samples
+#define ULP_VBAT_LOW 3.0f       // wake up the main CPU below this voltage (single LFP cell)
+#define ULP_VBAT_RING 64        // VBAT samples kept in RTC memory (power of 2; 16hrs @ 900s)
+#define ULP_PROG_WORDS 48       // max. ULP program size (32 bit words); data follows the program
+#if CONFIG_IDF_TARGET_ESP32S2
+#define ULP_ADC_MAXVAL 8191 // ULP ADC reads are 13 bit on the ESP32-S2
+#else
+#define ULP_ADC_MAXVAL 4095
+#endif
+
+// Wakeup reasons set by the ULP program
+#define ULP_WAKE_NONE 0
+#define ULP_WAKE_BUTTON 1
+#define ULP_WAKE_VBAT 2
+
+// Stop the ULP and collect its samples; returns the ULP wakeup reason (call in setup)
+extern int UlpMonitorBoot();
+// Load and start the ULP program (call right before entering DeepSleep)
+extern void UlpMonitorArm();
+// Publish collected VBAT samples to vcc_hist_topic (call in main loop while connected)
+extern void UlpMonitorPublish();
+#endif // ULP_MONITOR
+
+#endif // ULP_MONITOR_H
@@ -10,11 +10,14 @@
 #include <OneButtonTiny.h>
 #include <GxEPD2_3C.h>
 #include <Fonts/FreeMonoBold18pt7b.h>
+#include <Fonts/FreeMonoBold9pt7b.h>
+#include "sprites.h"
 
 //
 // Generic settings
 //
-#define WIFI_SLEEP_DURATION 1800 // seconds that Wifi will be off for power saving after receiving all required data
+// ATTN: settings marked with (*) are defaults in FLEET_MODE and can be changed at runtime (see fleet-config.h)
+#define WIFI_SLEEP_DURATION 1800 // seconds that Wifi will be off for power saving after receiving all required data (*)
 
 //
 // ePaper Display Configuration (Type: WaveShare GDEW0213Z16, 3 color)
@@ -27,11 +30,22 @@
 #define D_DC 33
 #define D_RST 21
 #define D_BUSY 18
-#define D_LANDSCAPE_ROT 3   // landscape with cables pointing downwards
+#define D_LANDSCAPE_ROT 3   // landscape with cables pointing downwards (*)
 #define D_CHARS_PER_LINE 10 // characters per line (using fixed width font!)
 #define D_X_OFFSET 1        // Pixel offset from the left display edge for first character
 #define D_Y_OFFSET 30       // Pixel offset for the first line
 #define D_Y_LINEHEIGTH 32   // Pixel heigth of each line
+#define D_ICON_AREA_W 36    // Pixel width reserved left of the text lines if the event has an icon (see sprites.h)
+#define D_CHARS_PER_LINE_ICON 8 // characters per line if the event has an icon
+
+// Countdown overlay: time remaining until the event deadline, shown below the icon in the left display column
+// The countdown region is updated by partial refresh only, at most D_CD_MAX_UPDATES times per event
+// and not more often than every D_CD_MIN_INTERVAL minutes (refreshes are only scheduled within the reminder period)
+// ATTN: the left display column will be reserved for all events, set maxCharsPerLine to D_CHARS_PER_LINE_ICON in the Feeder script!
+// #define D_COUNTDOWN
+#define D_CD_MIN_INTERVAL 60 // minutes
+#define D_CD_MAX_UPDATES 8   // partial refreshes per event
+#define D_CD_Y_OFFSET 92     // baseline of the countdown text (9pt font)
 
 //
 // FastLED Configuration
@@ -40,15 +54,37 @@
 #define FL_RING_DATA_PIN 13
 #define FL_RING_LED_TYPE WS2812B
 #define FL_RING_RGB_ORDER GRB    // usual color order for WS2812 chips
-#define FL_GLOBAL_BRIGHTNESS 8   // LED ring powered with 3,3V, keep power usage low
-#define FL_RING_BEATSIN_COSY 12  // Beatsin slow speed for cosy reminder
-#define FL_RING_BEATSIN_AGGRO 32 // Beatsin fast speed for agressive reminder
+#define FL_GLOBAL_BRIGHTNESS 8   // LED ring powered with 3,3V, keep power usage low (*)
+#define FL_RING_BEATSIN_COSY 12  // Beatsin slow speed for cosy reminder (*)
+#define FL_RING_BEATSIN_AGGRO 32 // Beatsin fast speed for agressive reminder (*)
+
+// LED ring rendering stage (see led-render.h): gamma / white balance correction and global brightness in 16 bit,
+// the fraction below one output step is shown by temporal dithering at a fixed frame rate.
+// Keeps colors distinguishable at low FL_GLOBAL_BRIGHTNESS (plain 8 bit scaling crushes them to a few levels).
+// #define LED_RENDER
+#define LED_RENDER_FPS 200         // max. frame rate; the animation advances by elapsed frame periods
+#define LED_RENDER_FADE 46         // fadeToBlackBy per frame period; same trail as 20 per loop at ~500 unlimited frames/s
+#define LED_DITHER_BITS 3          // fraction bits shown by dithering (3 = cycle of max. 8 frames, >= 25Hz; off while frames are late)
+#define LED_GAMMA 2.5f             // LED response
+#define LED_WHITE_BALANCE 0xFFB0F0 // channel scaling 0xRRGGBB (FastLED TypicalLEDStrip correction)
 
 //
 // Button Configuration
 //
 #define BUTTON_GPIO 12 // other wire of the pushbutton needs to be wired to GND - shorting the button pulls GPIO LOW
-#define BUT_SLEEP_DURATION 21600 // Sleep for 6hrs on button single click
+#define BUT_SLEEP_DURATION 21600 // Sleep for 6hrs on button single click if there's no active reminder
+
+// Snooze policy for button single click during active reminders (seconds, see snooze.cpp)
+// The ESP wakes up on timer or button press
+#define SNZ_COSY_DURATION 21600 // cosy reminder: sleep until aggressive reminder starts, but max. 6hrs
+#define SNZ_AGGRO_DURATION 3600 // aggressive reminder: sleep for 1hr
+#define SNZ_DEADLINE_LEAD 1800  // wake up 30min before the deadline at the latest
+#define SNZ_MIN_DURATION 300    // sleep at least 5min
+
+//
+// NVS (flash) namespace used to persist data (see eventstore.h and journal.h)
+//
+#define NVS_NAMESPACE "rmbrall"
 
 // Globar char arrays for topics containing ePaper text and appointment infos
 // larger MQTT_MAX_MSG_SIZE required
@@ -60,20 +96,38 @@ extern char StatusMsg[MQTT_MAX_MSG_SIZE];
 //
 // MQTT Topic tree prepended to all topics
 // ATTN: Must end with "/"!
+// In FLEET_MODE, the topic tree is loaded at runtime (see fleet-config.h)
 //
+#ifndef FLEET_MODE
 #define TOPTREE "HB7/Indoor/VZ/Rememberall/"
+#endif
 
 // MQTT Topic to receive event infos
-// Message format for eventTxt: "LineCount|ColorLine1;TextLine1|ColorLine2;TextLine2|..."
+// Message format for eventTxt: "LineCount[;IconID]|ColorLine1;TextLine1|ColorLine2;TextLine2|..."
 #define eventTxt_topic TOPTREE "eventTxt"
 // Message format for eventReminder: "EpochTimeStamp_EventDeadLine_in_hex|EpochTimeStamp_CosyReminder_in_hex|EpochTimeStamp_AgressiveReminder_in_hex|LedRingColor_in_0xRRGGBB"
 #define eventReminder_topic TOPTREE "eventReminder"
 #define Status_topic TOPTREE "Status" // Text message of what Rememberall is currently doing; set to "ack" if current reminder has been acknowledged by pressing the button
+// Journal of user actions (publish only, retained), see journal.h
+// Message format: "Seq;Action;EpochTimeStamp_in_hex;EventDeadline_in_hex|Seq;Action;..." (Action: A = acknowledged, S = reminder skipped)
+#define Journal_topic TOPTREE "Journal"
 // Position in the MqttSubscriptions array (to be able to keep track on topic updates)
 #define I_eventTxtSub 3
 #define I_eventReminderSub 4
 #define I_StatusSub 5
 
+// Content manifest: only fetch and decode eventTxt and eventReminder if they have changed (see manifest.h)
+// ATTN: requires a Feeder script version publishing the manifest, or eventTxt and eventReminder will never be fetched!
+// #define CONTENT_MANIFEST
+#ifdef CONTENT_MANIFEST
+// Message format: "Version_in_hex;eventTxt_FNV1a_in_hex;eventReminder_FNV1a_in_hex"
+#define Manifest_topic TOPTREE "Manifest"
+extern char ManifestMsg[MQTT_MAX_MSG_SIZE];
+#define I_ManifestSub 6
+#undef KEEP_RTC_SLOWMEM // to avoid compiler warning
+#define KEEP_RTC_SLOWMEM // hashes of decoded content are kept in RTC memory
+#endif
+
 struct eventInfoStruct
 {
     int LineCnt;                             // Number of lines to display
@@ -83,6 +137,7 @@ struct eventInfoStruct
     time_t CosyReminder;                     // cosy reminder
     time_t AgressiveReminder;                // agressive reminder
     uint32_t LedColor = 0xFF0000;            // Led reminder color (0xRRGGBB)
+    uint8_t IconId = ICON_NONE;              // Icon shown left of the text lines (see sprites.h)
 };
 
 // Declare user setup and main loop functions
@@ -94,14 +149,24 @@ void ButtonClickCB();
 void ButtonLongPressCB();
 void ButtonDoubleClickCB();
 
-// Display text drawing function with overloading up to 3 lines
-void DisplayText(char *Text, uint16_t Color);
-void DisplayText(char *Line1, uint16_t L1Color, char *Line2, uint16_t L2Color);
-void DisplayText(char *Line1, uint16_t L1Color, char *Line2, uint16_t L2Color, char *Line3, uint16_t L3Color);
+// Initialize peripherals on first use
+void DisplayBegin();
+void DisplayEnd();
+void LedRingBegin();
+
+// Display text drawing function with overloading up to 3 lines and optional icon
+void DisplayText(char *Text, uint16_t Color, uint8_t IconId = ICON_NONE);
+void DisplayText(char *Line1, uint16_t L1Color, char *Line2, uint16_t L2Color, uint8_t IconId = ICON_NONE);
+void DisplayText(char *Line1, uint16_t L1Color, char *Line2, uint16_t L2Color, char *Line3, uint16_t L3Color, uint8_t IconId = ICON_NONE);
+int16_t SideColumnWidth(uint8_t IconId);
+int16_t DrawSideColumn(uint8_t IconId);
+#ifdef D_COUNTDOWN
+void DisplayCountdown();
+#endif
 
 // Decoding functions for received MQTT messages
-bool DecodeDispTextMsg(char *msg, eventInfoStruct *EventData);
-bool DecodeReminderMsg(char *msg, eventInfoStruct *EventData);
+bool DecodeDispTextMsg(const char *msg, eventInfoStruct *EventData);
+bool DecodeReminderMsg(const char *msg, eventInfoStruct *EventData);
 
 // Button Actions
 typedef enum
@@ -0,0 +1,30 @@
+/*
+ *   ESP32 Template
+ *   DeepSleep wake stub declarations
+ */
+#ifndef WAKE_STUB_H
+#define WAKE_STUB_H
+
+#include <Arduino.h>
+#include "time-config.h"
+
+#ifdef WAKE_STUB
+//
+// DeepSleep wake stub
+// The stub runs from RTC fast memory right after wakeup, before the bootloader loads the firmware.
+// It sends the ESP back to sleep until the armed wakeup time (without a full boot) if the wakeup button has already
+// been released when the stub runs (spurious ext0 wakeup, e.g. noise on long wires).
+// Timer wakeups always boot: EnterDeepSleep arms the RTC timer for the next due work, so they are never early or idle.
+// The button is only armed by SnoozeSleep, other sleeps are not affected by the stub.
+// Requires RTC fast memory to stay powered during DeepSleep (KEEP_RTC_SLOWMEM is set automatically).
+//
+#define WAKE_STUB_MARGIN_MS 1000 // wakeups closer to the armed time than this will boot normally
+
+// Arm the wake stub for the following DeepSleep of SleepUs µs; pass the (active low) ext0 wakeup button or -1
+// ATTN: call right before entering DeepSleep
+extern void WakeStubArm(uint64_t SleepUs, int ButtonGpio);
+// Report wakeups handled by the stub since the last boot (call in setup)
+extern void WakeStubBoot();
+#endif // WAKE_STUB
+
+#endif // WAKE_STUB_H
@@ -14,6 +14,27 @@
 #define WIFISLEEP WIFI_PS_NONE
 // #define WIFISLEEP WIFI_PS_MIN_MODEM
 
+// Connected idle mode (CONNECTED_IDLE, see platformio.ini)
+// ===========================================================
+// Instead of switching WiFi off after the MQTT session, the ESP stays associated using max. modem sleep:
+// the radio only wakes up every WIFI_LISTEN_INTERVAL beacons (beacon interval usually 102.4ms) to check for buffered data,
+// so new messages are pushed by the broker with a latency of about WIFI_LISTEN_INTERVAL * 0.1s.
+// The MQTT keepalive (PINGREQ) wakes the radio for sending, so it should be way longer than the listen interval,
+// but shorter than the idle timeout of the broker and NAT/firewall devices in between.
+// The CPU is clocked down to CI_CPU_FREQ_MHZ only while idle and idles during CI_LOOP_DELAY (skipped while the LED ring
+// animates). Automatic light sleep between beacons additionally requires an Arduino core based on ESP-IDF 5 or newer,
+// built with CONFIG_PM_ENABLE and CONFIG_FREERTOS_USE_TICKLESS_IDLE (see README); the stock cores are not.
+// Time spent in connected idle is logged and recorded as DIAG_PH_IDLE (see diag.h) when WiFi goes down.
+#ifdef CONNECTED_IDLE
+#include <esp_pm.h>
+#define WIFI_LISTEN_INTERVAL 10 // wake up every 10th beacon (~1s push latency)
+#define CI_MQTT_KEEPALIVE 120   // MQTT keepalive in seconds (PubSubClient default: 15)
+#define CI_CPU_FREQ_MHZ 80      // CPU frequency; 80MHz is the minimum supported with WiFi enabled
+#define CI_LOOP_DELAY 50        // ms main loop delay while idle (keep below the button debounce time)
+#undef WIFISLEEP // to avoid compiler warning
+#define WIFISLEEP WIFI_PS_MAX_MODEM
+#endif
+
 // WiFi Connection Timeout (milliseconds)
 // See NET_OUTAGE action in platformio.ini on behavior when timeout is reached
 #define WIFI_CONNECT_TIMEOUT 15000
@@ -36,6 +57,10 @@ extern unsigned long NetRecoveryMillis; // store MCU "uptime" of the last networ
 #define NET_FAIL 2 // WiFi or MQTT broker failure
 
 // DHCP Hostname to report
+#ifdef FLEET_MODE
+#define WIFI_DHCPNAME FleetCfg.ClientName // loaded at runtime (see fleet-config.h)
+#else
 #define WIFI_DHCPNAME TEXTIFY(CLTNAME)
+#endif
 
 #endif // WIFI_CONFIG_H
\ No newline at end of file
@@ -0,0 +1,115 @@
+#
+# ESP32 Rememberall
+# PlatformIO extra script: static memory report per module
+#
+# Creates a linker map file and prints the static memory usage (DRAM, IRAM, RTC, Flash)
+# per source module / library after linking.
+# If "custom_static_ram_budget" (bytes) is set in platformio.ini, the build fails when
+# static DRAM usage (.data + .bss) exceeds the budget.
+#
+import os
+import re
+
+Import("env")
+
+MAP_FILE = os.path.join(env.subst("$BUILD_DIR"), env.subst("${PROGNAME}.map"))
+env.Append(LINKFLAGS=["-Wl,-Map," + MAP_FILE])
+
+# Output sections and the memory region they occupy
+REGIONS = {
+    ".dram0.data": "DRAM",
+    ".dram0.bss": "DRAM",
+    ".noinit": "DRAM",
+    ".iram0.text": "IRAM",
+    ".iram0.vectors": "IRAM",
+    ".iram0.data": "IRAM",
+    ".iram0.bss": "IRAM",
+    ".rtc.data": "RTC",
+    ".rtc.bss": "RTC",
+    ".rtc_noinit": "RTC",
+    ".rtc.text": "RTC",
+    ".flash.text": "Flash",
+    ".flash.rodata": "Flash",
+    ".flash.appdesc": "Flash",
+}
+COLUMNS = ["DRAM", "IRAM", "RTC", "Flash"]
+
+INPUT_RE = re.compile(r"^\s+(\S+)?\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S+)$")
+
+
+def module_name(obj):
+    # library archive: ".../libFastLED.a(FastLED.cpp.o)" -> "libFastLED.a"
+    if "(" in obj:
+        return os.path.basename(obj.split("(")[0])
+    name = os.path.basename(obj)
+    if name.endswith(".o"):
+        name = name[:-2]
+    return name
+
+
+def parse_map(path):
+    usage = {}
+    section = None
+    pending = None
+    with open(path, errors="replace") as f:
+        in_map = False
+        for line in f:
+            if not in_map:
+                in_map = line.startswith("Linker script and memory map")
+                continue
+            line = line.rstrip("\n")
+            if line and not line[0].isspace():
+                # new output section
+                section = line.split()[0]
+                pending = None
+                continue
+            if section not in REGIONS:
+                continue
+            m = INPUT_RE.match(line)
+            if m is None:
+                # long input section names wrap to the next line
+                stripped = line.strip()
+                pending = stripped if stripped.startswith(".") and " " not in stripped else None
+                continue
+            if (m.group(1) is None and pending is None) or m.group(1) == "*fill*":
+                pending = None
+                continue
+            size = int(m.group(3), 16)
+            if size == 0:
+                continue
+            mod = module_name(m.group(4))
+            usage.setdefault(mod, dict.fromkeys(COLUMNS, 0))
+            usage[mod][REGIONS[section]] += size
+            pending = None
+    return usage
+
+
+def mem_report(target, source, env):
+    if not os.path.isfile(MAP_FILE):
+        print("Memory report: map file %s not found" % MAP_FILE)
+        return 0
+    usage = parse_map(MAP_FILE)
+    totals = dict.fromkeys(COLUMNS, 0)
+    print("")
+    print("Static memory usage per module (bytes)")
+    print("%-36s %8s %8s %8s %8s" % tuple(["Module"] + COLUMNS))
+    for mod, sizes in sorted(usage.items(), key=lambda i: (i[1]["DRAM"], i[1]["Flash"]), reverse=True):
+        for col in COLUMNS:
+            totals[col] += sizes[col]
+        if sizes["DRAM"] or sizes["IRAM"] or sizes["RTC"] or sizes["Flash"] >= 1024:
+            print("%-36s %8d %8d %8d %8d" % tuple([mod[:36]] + [sizes[c] for c in COLUMNS]))
+    print("%-36s %8d %8d %8d %8d" % tuple(["Total"] + [totals[c] for c in COLUMNS]))
+
+    budget = env.GetProjectOption("custom_static_ram_budget", "")
+    if budget:
+        budget = int(budget, 0)
+        headroom = budget - totals["DRAM"]
+        print("Static DRAM budget: %d bytes, headroom: %d bytes" % (budget, headroom))
+        if headroom < 0:
+            print("Error: static DRAM usage exceeds custom_static_ram_budget!")
+            return 1
+    print("")
+    return 0
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", mem_report)
@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+#
+# ESP32 Template
+# Pack firmware images for OTA pull updates
+#
+# Creates a zlib compressed image, or a compressed delta against the currently running
+# firmware (see include/ota-decode.h for the delta format), and prints the request
+# for the OTApull topic if OTA_PWD is set in the environment.
+#
+# Usage:
+#   ota-pack.py NEW_VERSION new.bin out.bin                       (compressed image)
+#   ota-pack.py NEW_VERSION new.bin out.bin OLD_VERSION old.bin   (compressed delta)
+#
+import hashlib
+import hmac
+import os
+import struct
+import sys
+import zlib
+
+DELTA_MAGIC = b"RDIF"
+OP_COPY = 1
+OP_ADD = 2
+BLOCK = 32  # match granularity in bytes
+MIN_COPY = 12  # shorter matches are cheaper as literals
+
+
+def make_delta(old, new, base_version):
+    index = {}
+    for ofs in range(0, len(old) - BLOCK + 1, BLOCK):
+        index.setdefault(old[ofs:ofs + BLOCK], ofs)
+    out = bytearray(DELTA_MAGIC)
+    out += base_version.encode().ljust(16, b"\0")[:16]
+    out += struct.pack("<I", len(new))
+    literal_start = 0
+    pos = 0
+    while pos <= len(new) - BLOCK:
+        old_ofs = index.get(new[pos:pos + BLOCK])
+        if old_ofs is None:
+            pos += 1
+            continue
+        # extend match backwards into pending literals and forwards
+        start = pos
+        while start > literal_start and old_ofs > 0 and new[start - 1] == old[old_ofs - 1]:
+            start -= 1
+            old_ofs -= 1
+        end = pos + BLOCK
+        old_end = old_ofs + (end - start)
+        while end < len(new) and old_end < len(old) and new[end] == old[old_end]:
+            end += 1
+            old_end += 1
+        if end - start < MIN_COPY:
+            pos += 1
+            continue
+        if start > literal_start:
+            out += struct.pack("<BI", OP_ADD, start - literal_start) + new[literal_start:start]
+        out += struct.pack("<BII", OP_COPY, old_ofs, end - start)
+        literal_start = pos = end
+    if literal_start < len(new):
+        out += struct.pack("<BI", OP_ADD, len(new) - literal_start) + new[literal_start:]
+    return bytes(out)
+
+
+def main():
+    if len(sys.argv) not in (4, 6):
+        print("usage: ota-pack.py NEW_VERSION new.bin out.bin [OLD_VERSION old.bin]")
+        sys.exit(1)
+    version, new_file, out_file = sys.argv[1:4]
+    with open(new_file, "rb") as f:
+        new = f.read()
+    payload = new
+    if len(sys.argv) == 6:
+        with open(sys.argv[5], "rb") as f:
+            old = f.read()
+        payload = make_delta(old, new, sys.argv[4])
+    packed = zlib.compress(payload, 9)
+    with open(out_file, "wb") as f:
+        f.write(packed)
+    print("%s: %d bytes (image %d bytes, %.1f%%)" % (out_file, len(packed), len(new), 100.0 * len(packed) / len(new)))
+    pwd = os.environ.get("OTA_PWD")
+    if pwd:
+        mac = hmac.new(pwd.encode(), packed, hashlib.sha256).hexdigest()
+        print("OTApull request: %s|%s|<URL of %s>" % (version, mac, os.path.basename(out_file)))
+
+
+if __name__ == "__main__":
+    main()
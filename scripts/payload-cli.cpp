@@ -0,0 +1,333 @@
+/*
+ * ESP32 Rememberall
+ * Host CLI for the event topic payloads (include/payload-codec.h)
+ *
+ * Encodes and decodes eventTxt and eventReminder messages with the same codec the firmware uses, so a feeder
+ * can pipe its events through it instead of concatenating strings. Also round-trip checks and benchmarks the codec.
+ *
+ * Build:
+ *   g++ -std=c++17 -O2 -I include scripts/payload-cli.cpp -o payload-cli
+ * Usage:
+ *   payload-cli txt [-i ICON] COLOR TEXT [COLOR TEXT [COLOR TEXT]]     (prints eventTxt)
+ *   payload-cli reminder DEADLINE COSY AGGRESSIVE 0xRRGGBB              (epochs decimal or 0x hex, prints eventReminder)
+ *   payload-cli decode-txt [MSG]                                        (MSG or one message per line from stdin)
+ *   payload-cli decode-reminder [MSG]
+ *   payload-cli check [N]                                               (N random round trips)
+ *   payload-cli bench [N]                                               (time per encode / decode)
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "payload-codec.h"
+
+#define CLI_MSG_SIZE 512 // MQTT_MAX_MSG_SIZE of the firmware is smaller, longer messages are rejected there
+
+static void CliUsage()
+{
+    fprintf(stderr, "Usage: payload-cli txt [-i ICON] COLOR TEXT [COLOR TEXT [COLOR TEXT]]\n"
+                    "       payload-cli reminder DEADLINE COSY AGGRESSIVE 0xRRGGBB\n"
+                    "       payload-cli decode-txt [MSG]\n"
+                    "       payload-cli decode-reminder [MSG]\n"
+                    "       payload-cli check [N]\n"
+                    "       payload-cli bench [N]\n");
+    exit(2);
+}
+
+static bool CliNumber(const char *Arg, long long Min, long long Max, long long *Value)
+{
+    char *End;
+    *Value = strtoll(Arg, &End, 0);
+    return *Arg != '\0' && *End == '\0' && *Value >= Min && *Value <= Max;
+}
+
+static int CliEncodeTxt(int argc, char **argv)
+{
+    PayloadTxt Txt = {};
+    long long Value;
+    int i = 0;
+    if (argc >= 2 && strcmp(argv[0], "-i") == 0)
+    {
+        if (!CliNumber(argv[1], 0, 255, &Value))
+        {
+            CliUsage();
+        }
+        Txt.IconId = (uint8_t)Value;
+        i = 2;
+    }
+    if ((argc - i) % 2 != 0 || argc - i < 2 || argc - i > 2 * PAYLOAD_MAX_LINES)
+    {
+        CliUsage();
+    }
+    for (; i < argc; i += 2)
+    {
+        if (!CliNumber(argv[i], 0, 0xFFFF, &Value) || strlen(argv[i + 1]) > 255)
+        {
+            CliUsage();
+        }
+        Txt.LineCol[Txt.LineCnt] = (uint16_t)Value;
+        Txt.Text[Txt.LineCnt] = argv[i + 1];
+        Txt.TextLen[Txt.LineCnt] = (uint8_t)strlen(argv[i + 1]);
+        Txt.LineCnt++;
+    }
+    char Msg[CLI_MSG_SIZE];
+    if (PayloadEncodeTxt(&Txt, Msg, sizeof(Msg)) == 0)
+    {
+        fprintf(stderr, "Invalid text (empty or containing '|' or ';')\n");
+        return 1;
+    }
+    puts(Msg);
+    return 0;
+}
+
+static int CliEncodeReminder(int argc, char **argv)
+{
+    long long Values[4];
+    if (argc != 4)
+    {
+        CliUsage();
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        if (!CliNumber(argv[i], 0, (i < 3) ? 0x7FFFFFFFFFFFFFLL : 0xFFFFFF, &Values[i]))
+        {
+            CliUsage();
+        }
+    }
+    PayloadReminder Reminder = {Values[0], Values[1], Values[2], (uint32_t)Values[3]};
+    char Msg[CLI_MSG_SIZE];
+    PayloadEncodeReminder(&Reminder, Msg, sizeof(Msg));
+    puts(Msg);
+    return 0;
+}
+
+static bool CliDecodeTxt(const char *Msg)
+{
+    PayloadTxt Txt;
+    if (!PayloadDecodeTxt(Msg, &Txt))
+    {
+        if (Txt.ErrLine == PAYLOAD_ERR_LINECNT)
+            fprintf(stderr, "Invalid eventTxt \"%s\": LineCount does not match the lines\n", Msg);
+        else
+            fprintf(stderr, "Invalid eventTxt \"%s\": line %d\n", Msg, Txt.ErrLine);
+        return false;
+    }
+    printf("Lines %d, Icon %d\n", Txt.LineCnt, Txt.IconId);
+    for (int i = 0; i < Txt.LineCnt; i++)
+    {
+        printf("  %d: color %u \"%.*s\"\n", i + 1, Txt.LineCol[i], Txt.TextLen[i], Txt.Text[i]);
+    }
+    return true;
+}
+
+static bool CliDecodeReminder(const char *Msg)
+{
+    PayloadReminder Reminder;
+    if (!PayloadDecodeReminder(Msg, &Reminder))
+    {
+        fprintf(stderr, "Invalid eventReminder \"%s\"\n", Msg);
+        return false;
+    }
+    const int64_t Stamps[3] = {Reminder.Deadline, Reminder.CosyReminder, Reminder.AgressiveReminder};
+    const char *Names[3] = {"Deadline", "Cosy", "Aggressive"};
+    for (int i = 0; i < 3; i++)
+    {
+        time_t T = (time_t)Stamps[i];
+        char Buf[32];
+        strftime(Buf, sizeof(Buf), "%Y-%m-%d %H:%M:%S", localtime(&T));
+        printf("%-11s %lld (%s)\n", Names[i], (long long)Stamps[i], Buf);
+    }
+    printf("LED color   0x%06X\n", (unsigned)Reminder.LedColor);
+    return true;
+}
+
+static int CliDecode(int argc, char **argv, bool (*Decode)(const char *))
+{
+    if (argc > 1)
+    {
+        CliUsage();
+    }
+    if (argc == 1)
+    {
+        return Decode(argv[0]) ? 0 : 1;
+    }
+    int Rc = 0;
+    char Line[CLI_MSG_SIZE];
+    while (fgets(Line, sizeof(Line), stdin) != NULL)
+    {
+        Line[strcspn(Line, "\r\n")] = '\0';
+        if (!Decode(Line))
+        {
+            Rc = 1;
+        }
+    }
+    return Rc;
+}
+
+//
+// Round trip check and benchmark
+//
+static uint32_t CliRng = 1;
+static uint32_t CliRand()
+{
+    // xorshift32
+    CliRng ^= CliRng << 13;
+    CliRng ^= CliRng >> 17;
+    CliRng ^= CliRng << 5;
+    return CliRng;
+}
+
+// Random event with texts taken from TextBuf
+static void CliRandomEvent(PayloadTxt *Txt, PayloadReminder *Reminder, char *TextBuf)
+{
+    static const char Chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789 !#-+.:,()";
+    memset(Txt, 0, sizeof(PayloadTxt));
+    Txt->LineCnt = (uint8_t)(1 + CliRand() % PAYLOAD_MAX_LINES);
+    Txt->IconId = (uint8_t)(CliRand() % 5);
+    for (int i = 0; i < Txt->LineCnt; i++)
+    {
+        char *Text = &TextBuf[i * 16];
+        Txt->LineCol[i] = (uint16_t)((CliRand() % 4 == 0) ? CliRand() : CliRand() % 2);
+        Txt->TextLen[i] = (uint8_t)(1 + CliRand() % 12);
+        for (int c = 0; c < Txt->TextLen[i]; c++)
+        {
+            Text[c] = Chars[CliRand() % (sizeof(Chars) - 1)];
+        }
+        Txt->Text[i] = Text;
+    }
+    Reminder->Deadline = 1700000000LL + CliRand() % 300000000;
+    Reminder->CosyReminder = Reminder->Deadline - 24 * 3600;
+    Reminder->AgressiveReminder = Reminder->Deadline - 12 * 3600;
+    Reminder->LedColor = CliRand() & 0xFFFFFF;
+}
+
+static int CliCheck(int argc, char **argv)
+{
+    long long Iterations = 100000;
+    if (argc > 1 || (argc == 1 && !CliNumber(argv[0], 1, 100000000, &Iterations)))
+    {
+        CliUsage();
+    }
+    for (long long n = 0; n < Iterations; n++)
+    {
+        PayloadTxt Txt, TxtOut;
+        PayloadReminder Reminder, ReminderOut;
+        char TextBuf[16 * PAYLOAD_MAX_LINES];
+        char Msg[CLI_MSG_SIZE], Msg2[CLI_MSG_SIZE];
+        CliRandomEvent(&Txt, &Reminder, TextBuf);
+        bool Ok = PayloadEncodeTxt(&Txt, Msg, sizeof(Msg)) > 0 && PayloadDecodeTxt(Msg, &TxtOut) && TxtOut.LineCnt == Txt.LineCnt &&
+                  TxtOut.IconId == Txt.IconId;
+        for (int i = 0; Ok && i < Txt.LineCnt; i++)
+        {
+            Ok = TxtOut.LineCol[i] == Txt.LineCol[i] && TxtOut.TextLen[i] == Txt.TextLen[i] && memcmp(TxtOut.Text[i], Txt.Text[i], Txt.TextLen[i]) == 0;
+        }
+        // the encoded message must not change when encoded again
+        Ok = Ok && PayloadEncodeTxt(&TxtOut, Msg2, sizeof(Msg2)) > 0 && strcmp(Msg, Msg2) == 0;
+        if (!Ok)
+        {
+            fprintf(stderr, "eventTxt round trip failed: \"%s\"\n", Msg);
+            return 1;
+        }
+        Ok = PayloadEncodeReminder(&Reminder, Msg, sizeof(Msg)) > 0 && PayloadDecodeReminder(Msg, &ReminderOut) &&
+             ReminderOut.Deadline == Reminder.Deadline && ReminderOut.CosyReminder == Reminder.CosyReminder &&
+             ReminderOut.AgressiveReminder == Reminder.AgressiveReminder && ReminderOut.LedColor == Reminder.LedColor;
+        if (!Ok)
+        {
+            fprintf(stderr, "eventReminder round trip failed: \"%s\"\n", Msg);
+            return 1;
+        }
+        // messages truncated before the LED color must be rejected
+        Msg2[0] = '\0';
+        strncat(Msg2, Msg, CliRand() % (strrchr(Msg, '|') - Msg + 2));
+        if (PayloadDecodeReminder(Msg2, &ReminderOut))
+        {
+            fprintf(stderr, "Truncated eventReminder accepted: \"%s\"\n", Msg2);
+            return 1;
+        }
+    }
+    printf("%lld round trips OK\n", Iterations);
+    return 0;
+}
+
+static double CliSeconds()
+{
+    struct timespec Ts;
+    clock_gettime(CLOCK_MONOTONIC, &Ts);
+    return Ts.tv_sec + Ts.tv_nsec / 1e9;
+}
+
+static int CliBench(int argc, char **argv)
+{
+    long long Iterations = 1000000;
+    if (argc > 1 || (argc == 1 && !CliNumber(argv[0], 1, 1000000000, &Iterations)))
+    {
+        CliUsage();
+    }
+    // a few different events, encoded once
+    enum { EVENTS = 64 };
+    static char TextBuf[EVENTS][16 * PAYLOAD_MAX_LINES];
+    static PayloadTxt Txt[EVENTS];
+    static PayloadReminder Reminder[EVENTS];
+    static char TxtMsg[EVENTS][CLI_MSG_SIZE], ReminderMsg[EVENTS][CLI_MSG_SIZE];
+    for (int i = 0; i < EVENTS; i++)
+    {
+        CliRandomEvent(&Txt[i], &Reminder[i], TextBuf[i]);
+        PayloadEncodeTxt(&Txt[i], TxtMsg[i], CLI_MSG_SIZE);
+        PayloadEncodeReminder(&Reminder[i], ReminderMsg[i], CLI_MSG_SIZE);
+    }
+    char Msg[CLI_MSG_SIZE];
+    volatile size_t Sink = 0;
+    const char *Names[4] = {"encode eventTxt", "decode eventTxt", "encode eventReminder", "decode eventReminder"};
+    for (int Op = 0; Op < 4; Op++)
+    {
+        double Start = CliSeconds();
+        for (long long n = 0; n < Iterations; n++)
+        {
+            int i = (int)(n % EVENTS);
+            PayloadTxt TxtOut;
+            PayloadReminder ReminderOut;
+            switch (Op)
+            {
+            case 0:
+                Sink += PayloadEncodeTxt(&Txt[i], Msg, sizeof(Msg));
+                break;
+            case 1:
+                Sink += PayloadDecodeTxt(TxtMsg[i], &TxtOut) ? TxtOut.TextLen[0] : 0;
+                break;
+            case 2:
+                Sink += PayloadEncodeReminder(&Reminder[i], Msg, sizeof(Msg));
+                break;
+            case 3:
+                Sink += PayloadDecodeReminder(ReminderMsg[i], &ReminderOut) ? ReminderOut.LedColor : 0;
+                break;
+            }
+        }
+        printf("%-21s %7.1f ns\n", Names[Op], (CliSeconds() - Start) / Iterations * 1e9);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        CliUsage();
+    }
+    const char *Cmd = argv[1];
+    argc -= 2;
+    argv += 2;
+    if (strcmp(Cmd, "txt") == 0)
+        return CliEncodeTxt(argc, argv);
+    if (strcmp(Cmd, "reminder") == 0)
+        return CliEncodeReminder(argc, argv);
+    if (strcmp(Cmd, "decode-txt") == 0)
+        return CliDecode(argc, argv, CliDecodeTxt);
+    if (strcmp(Cmd, "decode-reminder") == 0)
+        return CliDecode(argc, argv, CliDecodeReminder);
+    if (strcmp(Cmd, "check") == 0)
+        return CliCheck(argc, argv);
+    if (strcmp(Cmd, "bench") == 0)
+        return CliBench(argc, argv);
+    CliUsage();
+    return 2;
+}
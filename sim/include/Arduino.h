@@ -0,0 +1,165 @@
+/*
+ *   ESP32 Rememberall
+ *   Host simulator: Arduino core stand-in
+ */
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include <sys/time.h>
+#include <algorithm>
+#include <string>
+#include "esp_attr.h"
+#include "esp_system.h"
+#include "esp_sleep.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+typedef uint8_t byte;
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define PROGMEM
+#define pgm_read_byte(Addr) (*(const uint8_t *)(Addr))
+#define pgm_read_word(Addr) (*(const uint16_t *)(Addr))
+#define ADC_0db 0
+#define ADC_2_5db 1
+#define ADC_6db 2
+#define ADC_11db 3
+#define constrain(Amt, Low, High) ((Amt) < (Low) ? (Low) : ((Amt) > (High) ? (High) : (Amt)))
+using std::max;
+using std::min;
+
+// Virtual time (see sim-host.h); the device system time is also returned by time() and gettimeofday()
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t Ms);
+void delayMicroseconds(uint32_t Us);
+void yield();
+time_t SimTime(time_t *Timer);
+int SimGettimeofday(struct timeval *Tv, void *Tz);
+#define time(Timer) SimTime(Timer)
+#define gettimeofday(Tv, Tz) SimGettimeofday(Tv, Tz)
+void configTzTime(const char *Tz, const char *Server1, const char *Server2 = nullptr, const char *Server3 = nullptr);
+bool getLocalTime(struct tm *Info, uint32_t Ms = 5000);
+
+// GPIO and ADC
+void pinMode(uint8_t Pin, uint8_t Mode);
+void digitalWrite(uint8_t Pin, uint8_t Val);
+int digitalRead(uint8_t Pin);
+uint16_t analogRead(uint8_t Pin);
+uint32_t analogReadMilliVolts(uint8_t Pin);
+void analogReadResolution(uint8_t Bits);
+void analogSetPinAttenuation(uint8_t Pin, int Attenuation);
+int8_t digitalPinToAnalogChannel(uint8_t Pin);
+float temperatureRead();
+bool setCpuFrequencyMhz(uint32_t Mhz);
+uint32_t getCpuFrequencyMhz();
+
+#if defined __GLIBC__ && (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38)
+size_t strlcpy(char *Dst, const char *Src, size_t Size);
+#endif
+
+class String
+{
+public:
+    String() {}
+    String(const char *Str) : Buf(Str ? Str : "") {}
+    String(const std::string &Str) : Buf(Str) {}
+    explicit String(char C) : Buf(1, C) {}
+    String(int Val) : Buf(std::to_string(Val)) {}
+    String(unsigned int Val) : Buf(std::to_string(Val)) {}
+    String(long Val) : Buf(std::to_string(Val)) {}
+    String(unsigned long Val) : Buf(std::to_string(Val)) {}
+    String(long long Val) : Buf(std::to_string(Val)) {}
+    String(unsigned long long Val) : Buf(std::to_string(Val)) {}
+    String(double Val, unsigned int Decimals = 2)
+    {
+        char Tmp[48];
+        snprintf(Tmp, sizeof(Tmp), "%.*f", Decimals, Val);
+        Buf = Tmp;
+    }
+    const char *c_str() const { return Buf.c_str(); }
+    unsigned int length() const { return (unsigned int)Buf.length(); }
+    long toInt() const { return strtol(Buf.c_str(), NULL, 10); }
+    float toFloat() const { return strtof(Buf.c_str(), NULL); }
+    bool equals(const String &Other) const { return Buf == Other.Buf; }
+    bool operator==(const String &Other) const { return Buf == Other.Buf; }
+    bool operator==(const char *Other) const { return Buf == Other; }
+    bool operator!=(const String &Other) const { return Buf != Other.Buf; }
+    String &operator+=(const String &Other)
+    {
+        Buf += Other.Buf;
+        return *this;
+    }
+    friend String operator+(const String &A, const String &B) { return String(A.Buf + B.Buf); }
+
+private:
+    std::string Buf;
+};
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t C) = 0;
+    virtual size_t write(const uint8_t *Buf, size_t Len)
+    {
+        for (size_t i = 0; i < Len; i++)
+        {
+            write(Buf[i]);
+        }
+        return Len;
+    }
+    size_t write(const char *Str) { return write((const uint8_t *)Str, strlen(Str)); }
+    size_t print(const char *Str) { return write(Str); }
+    size_t print(const String &Str) { return write(Str.c_str()); }
+    size_t print(char C) { return write((uint8_t)C); }
+    size_t print(int Val) { return print(String(Val)); }
+    size_t print(unsigned int Val) { return print(String(Val)); }
+    size_t print(long Val) { return print(String(Val)); }
+    size_t print(unsigned long Val) { return print(String(Val)); }
+    size_t print(double Val, int Decimals = 2) { return print(String(Val, Decimals)); }
+    size_t println() { return write('\n'); }
+    template <class T>
+    size_t println(const T &Val)
+    {
+        return print(Val) + println();
+    }
+    size_t printf(const char *Fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class HardwareSerial : public Print
+{
+public:
+    using Print::write;
+    void begin(unsigned long Baud) {}
+    void flush() {}
+    int available() { return 0; }
+    operator bool() { return true; }
+    size_t write(uint8_t C) override;
+    size_t write(const uint8_t *Buf, size_t Len) override;
+};
+extern HardwareSerial Serial;
+
+class EspClass
+{
+public:
+    [[noreturn]] void restart();
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+    uint32_t getMaxAllocHeap();
+    uint32_t getHeapSize();
+    uint64_t getEfuseMac();
+    const char *getSdkVersion() { return "host-sim"; }
+};
+extern EspClass ESP;
+
+#endif // ARDUINO_H
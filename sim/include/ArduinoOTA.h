@@ -0,0 +1,31 @@
+/*
+ *   ESP32 Rememberall
+ *   Host simulator: ArduinoOTA stand-in (no uploads)
+ */
+#ifndef ARDUINOOTA_H
+#define ARDUINOOTA_H
+
+#include <Arduino.h>
+#include <functional>
+
+typedef int ota_error_t;
+#define U_FLASH 0
+#define U_SPIFFS 100
+
+class ArduinoOTAClass
+{
+public:
+    ArduinoOTAClass &setHostname(const char *Name) { return *this; }
+    ArduinoOTAClass &setPassword(const char *Pwd) { return *this; }
+    ArduinoOTAClass &onStart(std::function<void()> Fn) { return *this; }
+    ArduinoOTAClass &onEnd(std::function<void()> Fn) { return *this; }
+    ArduinoOTAClass &onProgress(std::function<void(unsigned int, unsigned int)> Fn) { return *this; }
+    ArduinoOTAClass &onError(std::function<void(ota_error_t)> Fn) { return *this; }
+    void begin() {}
+    void end() {}
+    void handle() {}
+    int getCommand() { return U_FLASH; }
+};
+extern ArduinoOTAClass ArduinoOTA;
+
+#endif // ARDUINOOTA_H
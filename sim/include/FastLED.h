@@ -0,0 +1,102 @@
+/*
+ *   ESP32 Rememberall
+ *   Host simulator: FastLED stand-in; show() takes the WS2812 transfer time of the frame
+ */
+#ifndef FASTLED_H
+#define FASTLED_H
+
+#include <Arduino.h>
+#include "sim-host.h"
+
+#define WS2812B 0
+#define DISABLE_DITHER 0x00
+#define BINARY_DITHER 0x01
+enum EOrder
+{
+    RGB = 0012,
+    GRB = 0102,
+};
+
+static inline uint8_t qadd8(uint8_t A, uint8_t B)
+{
+    unsigned int Sum = A + B;
+    return (Sum > 255) ? 255 : (uint8_t)Sum;
+}
+
+static inline uint8_t scale8(uint8_t Val, uint8_t Scale)
+{
+    return (uint8_t)(((uint16_t)Val * (1 + (uint16_t)Scale)) >> 8);
+}
+
+struct CRGB
+{
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+    enum HTMLColorCode
+    {
+        Black = 0x000000,
+        Red = 0xFF0000,
+        Green = 0x008000,
+        Blue = 0x0000FF,
+        White = 0xFFFFFF,
+    };
+    CRGB() : r(0), g(0), b(0) {}
+    CRGB(uint8_t R, uint8_t G, uint8_t B) : r(R), g(G), b(B) {}
+    CRGB(uint32_t Code) : r((Code >> 16) & 0xFF), g((Code >> 8) & 0xFF), b(Code & 0xFF) {}
+    CRGB(HTMLColorCode Code) : CRGB((uint32_t)Code) {}
+    CRGB &operator+=(const CRGB &Rhs)
+    {
+        r = qadd8(r, Rhs.r);
+        g = qadd8(g, Rhs.g);
+        b = qadd8(b, Rhs.b);
+        return *this;
+    }
+    CRGB &nscale8(uint8_t Scale)
+    {
+        r = scale8(r, Scale);
+        g = scale8(g, Scale);
+        b = scale8(b, Scale);
+        return *this;
+    }
+};
+
+void fill_solid(CRGB *Leds, int Num, const CRGB &Color);
+void fadeToBlackBy(CRGB *Leds, uint16_t Num, uint8_t FadeBy);
+uint16_t beatsin16(uint16_t Bpm, uint16_t Low = 0, uint16_t High = 65535);
+
+class CFastLED
+{
+public:
+    template <int Chipset, int DataPin, EOrder Order>
+    CFastLED &addLeds(CRGB *Leds, int Num)
+    {
+        this->Leds = Leds;
+        this->Num = Num;
+        return *this;
+    }
+    void setBrightness(uint8_t Scale) { Brightness = Scale; }
+    uint8_t getBrightness() { return Brightness; }
+    void setDither(uint8_t Mode) { Dither = Mode; }
+    void show() { SimLedShow(Num); }
+    void clear(bool WriteData = false)
+    {
+        if (Leds)
+        {
+            fill_solid(Leds, Num, CRGB::Black);
+        }
+        if (WriteData)
+        {
+            show();
+        }
+    }
+
+private:
+    CRGB *Leds = NULL;
+    int Num = 0;
+    uint8_t Brightness = 255;
+    uint8_t Dither = BINARY_DITHER;
+};
+extern CFastLED FastLED;
+
+#endif // FASTLED_H
@@ -0,0 +1,3 @@
+#pragma once
+#include <gfxfont.h>
+const GFXfont FreeMonoBold18pt7b = {21, 35};
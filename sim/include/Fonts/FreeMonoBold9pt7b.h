@@ -0,0 +1,3 @@
+#pragma once
+#include <gfxfont.h>
+const GFXfont FreeMonoBold9pt7b = {11, 18};
@@ -0,0 +1,74 @@
+/*
+ *   ESP32 Rememberall
+ *   Host simulator: GxEPD2 3 color display stand-in; drawing is discarded, refreshes are counted and take SIM_EPD_REFRESH_MS
+ */
+#ifndef GXEPD2_3C_H
+#define GXEPD2_3C_H
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <gfxfont.h>
+#include "sim-host.h"
+
+#define GxEPD_BLACK 0x0000
+#define GxEPD_WHITE 0xFFFF
+#define GxEPD_RED 0xF800
+
+class GxEPD2_213c
+{
+public:
+    static const uint16_t WIDTH = 104;
+    static const uint16_t HEIGHT = 212;
+    GxEPD2_213c(int16_t Cs, int16_t Dc, int16_t Rst, int16_t Busy) {}
+    void selectSPI(SPIClass &Spi, SPISettings Settings) {}
+};
+
+template <typename GxEPD2_Type, const uint16_t page_height>
+class GxEPD2_3C : public Print
+{
+public:
+    GxEPD2_Type epd2;
+    GxEPD2_3C(GxEPD2_Type Epd) : epd2(Epd) {}
+    using Print::write;
+    size_t write(uint8_t C) override { return 1; }
+    void init(uint32_t SerialDiagBitrate, bool Initial, uint16_t ResetDuration, bool PulldownRstMode) {}
+    void hibernate() {}
+    void powerOff() {}
+    void setRotation(uint8_t Rot) { Rotation = Rot & 3; }
+    int16_t width() { return (Rotation & 1) ? GxEPD2_Type::HEIGHT : GxEPD2_Type::WIDTH; }
+    int16_t height() { return (Rotation & 1) ? GxEPD2_Type::WIDTH : GxEPD2_Type::HEIGHT; }
+    void setFont(const GFXfont *Font) { this->Font = Font; }
+    void setTextColor(uint16_t Color) {}
+    void setTextSize(uint8_t Size) {}
+    void setCursor(int16_t X, int16_t Y) {}
+    void getTextBounds(const char *Str, int16_t X, int16_t Y, int16_t *X1, int16_t *Y1, uint16_t *W, uint16_t *H)
+    {
+        uint8_t XAdv = Font ? Font->xAdvance : 6;
+        uint8_t YAdv = Font ? Font->yAdvance : 8;
+        *X1 = X;
+        *Y1 = Y - (int16_t)(YAdv * 2 / 3);
+        *W = (uint16_t)(strlen(Str) * XAdv);
+        *H = (uint16_t)(YAdv * 2 / 3);
+    }
+    void setFullWindow() { Partial = false; }
+    void setPartialWindow(int16_t X, int16_t Y, int16_t W, int16_t H) { Partial = true; }
+    void firstPage() {}
+    bool nextPage()
+    {
+        // single page, refresh when drawing is finished
+        SimEpdRefresh(Partial);
+        return false;
+    }
+    void clearScreen(uint8_t Value = 0xFF) { SimEpdRefresh(false); }
+    void fillScreen(uint16_t Color) {}
+    void fillRect(int16_t X, int16_t Y, int16_t W, int16_t H, uint16_t Color) {}
+    void drawPixel(int16_t X, int16_t Y, uint16_t Color) {}
+    void drawBitmap(int16_t X, int16_t Y, const uint8_t *Bitmap, int16_t W, int16_t H, uint16_t Color) {}
+
+private:
+    uint8_t Rotation = 0;
+    bool Partial = false;
+    const GFXfont *Font = NULL;
+};
+
+#endif // GXEPD2_3C_H
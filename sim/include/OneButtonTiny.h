@@ -0,0 +1,49 @@
+/*
+ *   ESP32 Rememberall
+ *   Host simulator: OneButtonTiny stand-in, clicks are generated by the scenario
+ */
+#ifndef ONEBUTTONTINY_H
+#define ONEBUTTONTINY_H
+
+#include "sim-host.h"
+
+class OneButtonTiny
+{
+public:
+    typedef void (*callbackFunction)(void);
+    OneButtonTiny(const int Pin, const bool ActiveLow = true, const bool PullupActive = true) {}
+    void attachClick(callbackFunction Fn) { ClickFn = Fn; }
+    void attachDoubleClick(callbackFunction Fn) { DoubleClickFn = Fn; }
+    void attachLongPressStart(callbackFunction Fn) { LongPressFn = Fn; }
+    void setDebounceMs(const int Ms) {}
+    void setClickMs(const int Ms) {}
+    void setPressMs(const int Ms) {}
+    bool isIdle() const { return true; }
+    void tick()
+    {
+        callbackFunction Fn = NULL;
+        switch (SimButtonTake())
+        {
+        case SIM_BTN_CLICK:
+            Fn = ClickFn;
+            break;
+        case SIM_BTN_DOUBLE:
+            Fn = DoubleClickFn;
+            break;
+        case SIM_BTN_LONG:
+            Fn = LongPressFn;
+            break;
+        }
+        if (Fn)
+        {
+            Fn();
+        }
+    }
+
+private:
+    callbackFunction ClickFn = NULL;
+    callbackFunction DoubleClickFn = NULL;
+    callbackFunction LongPressFn = NULL;
+};
+
+#endif // ONEBUTTONTINY_H
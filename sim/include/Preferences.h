@@ -0,0 +1,65 @@
+/*
+ *   ESP32 Rememberall
+ *   Host simulator: NVS stand-in (kept for the whole simulation, writes are counted)
+ */
+#ifndef PREFERENCES_H
+#define PREFERENCES_H
+
+#include <Arduino.h>
+#include "sim-host.h"
+
+class Preferences
+{
+public:
+    bool begin(const char *Name, bool ReadOnly = false)
+    {
+        strlcpy(Ns, Name, sizeof(Ns));
+        this->ReadOnly = ReadOnly;
+        return true;
+    }
+    void end() { Ns[0] = '\0'; }
+    bool isKey(const char *Key) { return SimNvsFind(Ns, Key, false) != NULL; }
+    bool remove(const char *Key)
+    {
+        SimNvsEntry *Entry = SimNvsFind(Ns, Key, false);
+        if (Entry == NULL || ReadOnly)
+        {
+            return false;
+        }
+        Entry->Ns[0] = '\0';
+        return true;
+    }
+    size_t getBytesLength(const char *Key)
+    {
+        SimNvsEntry *Entry = SimNvsFind(Ns, Key, false);
+        return Entry ? Entry->Len : 0;
+    }
+    size_t getBytes(const char *Key, void *Buf, size_t Len)
+    {
+        SimNvsEntry *Entry = SimNvsFind(Ns, Key, false);
+        if (Entry == NULL || Entry->Len > Len)
+        {
+            return 0;
+        }
+        memcpy(Buf, Entry->Data, Entry->Len);
+        return Entry->Len;
+    }
+    size_t putBytes(const char *Key, const void *Buf, size_t Len)
+    {
+        SimNvsEntry *Entry = ReadOnly ? NULL : SimNvsFind(Ns, Key, true);
+        if (Entry == NULL || Len > SIM_NVS_LEN)
+        {
+            return 0;
+        }
+        memcpy(Entry->Data, Buf, Len);
+        Entry->Len = (uint16_t)Len;
+        Sim->Stats.NvsWrites++;
+        return Len;
+    }
+
+private:
+    char Ns[16] = "";
+    bool ReadOnly = false;
+};
+
+#endif // PREFERENCES_H
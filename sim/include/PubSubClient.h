@@ -0,0 +1,94 @@
+/*
+ *   ESP32 Rememberall
+ *   Host simulator: PubSubClient stand-in connected to the in-process broker
+ */
+#ifndef PUBSUBCLIENT_H
+#define PUBSUBCLIENT_H
+
+#include <Arduino.h>
+#include <functional>
+#include <WiFi.h>
+#include "sim-host.h"
+
+#define MQTT_CONNECTION_TIMEOUT -4
+#define MQTT_CONNECTION_LOST -3
+#define MQTT_CONNECT_FAILED -2
+#define MQTT_DISCONNECTED -1
+#define MQTT_CONNECTED 0
+#define MQTT_CALLBACK_SIGNATURE std::function<void(char *, uint8_t *, unsigned int)> callback
+
+// Like PubSubClient, loop() handles at most one incoming message per call and publish() uses QoS 0
+class PubSubClient
+{
+public:
+    PubSubClient(const char *Domain, uint16_t Port, MQTT_CALLBACK_SIGNATURE, Client &Clt) : Callback(callback) {}
+    bool connect(const char *Id)
+    {
+        State = SimMqttConnect() ? MQTT_CONNECTED : MQTT_CONNECT_FAILED;
+        return State == MQTT_CONNECTED;
+    }
+    void disconnect()
+    {
+        SimMqttDisconnect();
+        State = MQTT_DISCONNECTED;
+    }
+    bool connected()
+    {
+        if (State == MQTT_CONNECTED && !Sim->Session)
+        {
+            State = MQTT_CONNECTION_LOST;
+        }
+        return State == MQTT_CONNECTED;
+    }
+    int state() { return State; }
+    bool subscribe(const char *Topic, uint8_t Qos = 0) { return connected() && SimMqttSubscribe(Topic); }
+    bool publish(const char *Topic, const char *Payload, bool Retained = false) { return publish(Topic, (const uint8_t *)Payload, strlen(Payload), Retained); }
+    bool publish(const char *Topic, const uint8_t *Payload, unsigned int Len, bool Retained)
+    {
+        if (!connected())
+        {
+            return false;
+        }
+        SimBrokerPublish(Topic, (const char *)Payload, Len, Retained, true);
+        return true;
+    }
+    bool beginPublish(const char *Topic, unsigned int Len, bool Retained)
+    {
+        PubTopic = Topic;
+        PubPayload.clear();
+        PubRetained = Retained;
+        return connected();
+    }
+    size_t write(const uint8_t *Buf, size_t Len)
+    {
+        PubPayload.append((const char *)Buf, Len);
+        return Len;
+    }
+    size_t write(uint8_t C) { return write(&C, 1); }
+    int endPublish() { return publish(PubTopic.c_str(), (const uint8_t *)PubPayload.data(), PubPayload.size(), PubRetained) ? 1 : 0; }
+    bool loop()
+    {
+        if (!connected())
+        {
+            return false;
+        }
+        SimMsg Msg;
+        if (SimMqttPoll(&Msg) && Callback)
+        {
+            Callback(Msg.Topic, (uint8_t *)Msg.Payload, Msg.Len);
+        }
+        return true;
+    }
+    bool setKeepAlive(uint16_t Seconds) { return true; }
+    bool setSocketTimeout(uint16_t Seconds) { return true; }
+    bool setBufferSize(uint16_t Size) { return Size <= SIM_MSG_LEN + SIM_TOPIC_LEN; }
+
+private:
+    std::function<void(char *, uint8_t *, unsigned int)> Callback;
+    int State = MQTT_DISCONNECTED;
+    std::string PubTopic;
+    std::string PubPayload;
+    bool PubRetained = false;
+};
+
+#endif // PUBSUBCLIENT_H
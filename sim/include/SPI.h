@@ -0,0 +1,29 @@
+/*
+ *   ESP32 Rememberall
+ *   Host simulator: SPI stand-in
+ */
+#ifndef SPI_H
+#define SPI_H
+
+#include <stdint.h>
+
+#define FSPI 0
+#define HSPI 1
+#define MSBFIRST 1
+#define SPI_MODE0 0
+
+class SPISettings
+{
+public:
+    SPISettings(uint32_t Clock, uint8_t BitOrder, uint8_t DataMode) {}
+};
+
+class SPIClass
+{
+public:
+    SPIClass(uint8_t Bus) {}
+    void begin(int8_t Sck, int8_t Miso, int8_t Mosi, int8_t Ss) {}
+    void end() {}
+};
+
+#endif // SPI_H
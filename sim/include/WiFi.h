@@ -0,0 +1,71 @@
+/*
+ *   ESP32 Rememberall
+ *   Host simulator: WiFi stand-in
+ */
+#ifndef WIFI_H
+#define WIFI_H
+
+#include <Arduino.h>
+#include "esp_wifi.h"
+#include "sim-host.h"
+
+typedef enum
+{
+    WIFI_PS_NONE,
+    WIFI_PS_MIN_MODEM,
+    WIFI_PS_MAX_MODEM,
+} wifi_ps_type_t;
+
+typedef enum
+{
+    WIFI_MODE_NULL,
+    WIFI_MODE_STA,
+    WIFI_MODE_AP,
+    WIFI_MODE_APSTA,
+} wifi_mode_t;
+
+class IPAddress
+{
+public:
+    IPAddress(uint32_t Addr = 0) : Addr(Addr) {}
+    operator uint32_t() const { return Addr; }
+
+private:
+    uint32_t Addr;
+};
+
+// Association takes SIM_WIFI_CONNECT_MS after begin(), the radio is on until disconnect() or DeepSleep
+class WiFiClass
+{
+public:
+    bool mode(wifi_mode_t Mode) { return true; }
+    bool setSleep(wifi_ps_type_t Sleep) { return true; }
+    bool setHostname(const char *Name) { return true; }
+    void begin() { SimWifiBegin(); }
+    void begin(const char *Ssid, const char *Psk) { SimWifiBegin(); }
+    bool isConnected() { return SimWifiConnected(); }
+    bool disconnect(bool WifiOff = false, bool EraseAp = false)
+    {
+        SimWifiOff();
+        return true;
+    }
+    IPAddress localIP() { return IPAddress(SimWifiConnected() ? 0x6498A8C0 : 0); }
+};
+extern WiFiClass WiFi;
+
+class Client : public Print
+{
+public:
+    virtual void stop() = 0;
+};
+
+// Transport of the PubSubClient; the broker is simulated in-process (see sim-net.cpp)
+class WiFiClient : public Client
+{
+public:
+    using Print::write;
+    size_t write(uint8_t C) override { return 1; }
+    void stop() override { SimMqttDisconnect(); }
+};
+
+#endif // WIFI_H
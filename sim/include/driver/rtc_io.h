@@ -0,0 +1,15 @@
+/*
+ *   ESP32 Rememberall
+ *   Host simulator: RTC GPIO stand-in
+ */
+#ifndef DRIVER_RTC_IO_H
+#define DRIVER_RTC_IO_H
+
+#include "esp_sleep.h"
+
+esp_err_t rtc_gpio_pullup_en(gpio_num_t Pin);
+esp_err_t rtc_gpio_pulldown_dis(gpio_num_t Pin);
+esp_err_t rtc_gpio_hold_en(gpio_num_t Pin);
+esp_err_t rtc_gpio_hold_dis(gpio_num_t Pin);
+
+#endif // DRIVER_RTC_IO_H
@@ -0,0 +1,14 @@
+/*
+ *   ESP32 Rememberall
+ *   Host simulator: memory placement attributes
+ */
+#ifndef ESP_ATTR_H
+#define ESP_ATTR_H
+
+// RTC memory is emulated by sections which are saved and restored around the simulated boots (see sim-main.cpp)
+#define RTC_DATA_ATTR __attribute__((section("rtcsim_data")))
+#define RTC_NOINIT_ATTR __attribute__((section("rtcsim_noinit")))
+#define RTC_IRAM_ATTR
+#define IRAM_ATTR
+
+#endif // ESP_ATTR_H
@@ -0,0 +1,19 @@
+/*
+ *   ESP32 Rememberall
+ *   Host simulator: power management stand-in
+ */
+#ifndef ESP_PM_H
+#define ESP_PM_H
+
+#include "esp_system.h"
+
+typedef struct
+{
+    int max_freq_mhz;
+    int min_freq_mhz;
+    bool light_sleep_enable;
+} esp_pm_config_t;
+
+esp_err_t esp_pm_configure(const void *Config);
+
+#endif // ESP_PM_H
@@ -0,0 +1,50 @@
+/*
+ *   ESP32 Rememberall
+ *   Host simulator: DeepSleep stand-in
+ */
+#ifndef ESP_SLEEP_H
+#define ESP_SLEEP_H
+
+#include <stdint.h>
+#include "esp_system.h"
+
+typedef int gpio_num_t;
+
+typedef enum
+{
+    ESP_PD_DOMAIN_RTC_PERIPH,
+    ESP_PD_DOMAIN_RTC_SLOW_MEM,
+    ESP_PD_DOMAIN_RTC_FAST_MEM,
+    ESP_PD_DOMAIN_RTC8M,
+    ESP_PD_DOMAIN_RC_FAST = ESP_PD_DOMAIN_RTC8M,
+} esp_sleep_pd_domain_t;
+
+typedef enum
+{
+    ESP_PD_OPTION_OFF,
+    ESP_PD_OPTION_ON,
+    ESP_PD_OPTION_AUTO,
+} esp_sleep_pd_option_t;
+
+typedef enum
+{
+    ESP_SLEEP_WAKEUP_UNDEFINED,
+    ESP_SLEEP_WAKEUP_ALL,
+    ESP_SLEEP_WAKEUP_EXT0,
+    ESP_SLEEP_WAKEUP_EXT1,
+    ESP_SLEEP_WAKEUP_TIMER,
+    ESP_SLEEP_WAKEUP_TOUCHPAD,
+    ESP_SLEEP_WAKEUP_ULP,
+    ESP_SLEEP_WAKEUP_GPIO,
+    ESP_SLEEP_WAKEUP_UART,
+} esp_sleep_source_t;
+typedef esp_sleep_source_t esp_sleep_wakeup_cause_t;
+
+esp_err_t esp_sleep_pd_config(esp_sleep_pd_domain_t Domain, esp_sleep_pd_option_t Option);
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t Us);
+esp_err_t esp_sleep_enable_ext0_wakeup(gpio_num_t Pin, int Level);
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause();
+[[noreturn]] void esp_deep_sleep(uint64_t Us);
+[[noreturn]] void esp_deep_sleep_start();
+
+#endif // ESP_SLEEP_H
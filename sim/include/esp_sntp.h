@@ -0,0 +1,20 @@
+/*
+ *   ESP32 Rememberall
+ *   Host simulator: SNTP stand-in
+ */
+#ifndef ESP_SNTP_H
+#define ESP_SNTP_H
+
+#include <stdint.h>
+#include <sys/time.h>
+
+// The simulated NTP server answers SIM_NTP_MS after configTzTime if WiFi is connected
+#define SNTP_SYNC_MODE_IMMED 0
+#define SNTP_SYNC_MODE_SMOOTH 1
+
+void sntp_set_time_sync_notification_cb(void (*Cb)(struct timeval *Tv));
+void sntp_set_sync_mode(int Mode);
+void sntp_set_sync_interval(uint32_t IntervalMs);
+void sntp_stop();
+
+#endif // ESP_SNTP_H
@@ -0,0 +1,13 @@
+/*
+ *   ESP32 Rememberall
+ *   Host simulator: high resolution timer stand-in
+ */
+#ifndef ESP_TIMER_H
+#define ESP_TIMER_H
+
+#include <stdint.h>
+
+// Microseconds since boot (virtual time)
+int64_t esp_timer_get_time();
+
+#endif // ESP_TIMER_H
@@ -0,0 +1,29 @@
+/*
+ *   ESP32 Rememberall
+ *   Host simulator: ESP-IDF WiFi configuration stand-in
+ */
+#ifndef ESP_WIFI_H
+#define ESP_WIFI_H
+
+#include <stdint.h>
+#include "esp_system.h"
+
+typedef enum
+{
+    WIFI_IF_STA,
+    WIFI_IF_AP,
+} wifi_interface_t;
+
+typedef union
+{
+    struct
+    {
+        uint8_t ssid[32];
+        uint8_t password[64];
+        uint16_t listen_interval;
+    } sta;
+} wifi_config_t;
+
+esp_err_t esp_wifi_set_config(wifi_interface_t Interface, wifi_config_t *Config);
+
+#endif // ESP_WIFI_H
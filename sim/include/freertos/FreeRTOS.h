@@ -0,0 +1,19 @@
+/*
+ *   ESP32 Rememberall
+ *   Host simulator: FreeRTOS stand-in
+ */
+#ifndef FREERTOS_H
+#define FREERTOS_H
+
+#include <stdint.h>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS pdTRUE
+#define pdMS_TO_TICKS(Ms) ((TickType_t)(Ms))
+#define portTICK_PERIOD_MS 1
+
+#endif // FREERTOS_H
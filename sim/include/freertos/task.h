@@ -0,0 +1,18 @@
+/*
+ *   ESP32 Rememberall
+ *   Host simulator: FreeRTOS task stand-in
+ */
+#ifndef FREERTOS_TASK_H
+#define FREERTOS_TASK_H
+
+#include "freertos/FreeRTOS.h"
+
+// Tasks run as host threads; vTaskDelay sleeps in host time outside of the main task
+typedef void *TaskHandle_t;
+#define tskIDLE_PRIORITY 0
+
+BaseType_t xTaskCreate(void (*Task)(void *), const char *Name, uint32_t StackDepth, void *Param, UBaseType_t Priority, TaskHandle_t *Handle);
+void vTaskDelay(TickType_t Ticks);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t Task);
+
+#endif // FREERTOS_TASK_H
@@ -0,0 +1,16 @@
+/*
+ *   ESP32 Rememberall
+ *   Host simulator: Adafruit GFX font structure (metrics only)
+ */
+#ifndef GFXFONT_H
+#define GFXFONT_H
+
+#include <stdint.h>
+
+typedef struct
+{
+    uint8_t xAdvance; // fixed width fonts only
+    uint8_t yAdvance;
+} GFXfont;
+
+#endif // GFXFONT_H
@@ -0,0 +1,201 @@
+/*
+ *   ESP32 Rememberall
+ *   Host simulator: interface between the framework stand-ins and the simulator core
+ */
+#ifndef SIM_HOST_H
+#define SIM_HOST_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+//
+// Simulation parameters (defaults, most can be changed on the command line, see sim-main.cpp)
+//
+#define SIM_LOOP_US 1000            // virtual CPU time per main loop iteration
+#define SIM_WIFI_CONNECT_MS 1500    // WiFi association and DHCP
+#define SIM_BROKER_RTT_MS 20        // round trip time to the broker
+#define SIM_NTP_MS 50               // NTP response time
+#define SIM_EPD_REFRESH_MS 15000    // 3 color ePaper refresh (full and partial window take about the same time)
+#define SIM_LED_US_PER_PIXEL 30     // WS2812 data rate (24 bits @ 800kHz)
+#define SIM_BTN_CLICK_MS 400        // OneButtonTiny click detection delay after release
+#define SIM_VCC 3.3f                // battery voltage returned by analogRead
+#define SIM_JITTER_PCT 20           // random deviation of round trip and WiFi connect times
+
+// Sizes of the shared simulation state
+#define SIM_RTC_SIZE 8192    // RTC slow memory (ESP32-S2)
+#define SIM_TOPIC_LEN 96
+#define SIM_MSG_LEN 320
+#define SIM_RETAINED 48      // retained messages on the broker
+#define SIM_QUEUE 64         // messages in flight to the device
+#define SIM_SUBS 24          // subscriptions of the device
+#define SIM_NVS_ENTRIES 16
+#define SIM_NVS_LEN 512
+#define SIM_ACK_HIST 256     // acknowledge latencies kept for the report
+
+// Process exit codes of a simulated boot
+#define SIM_EXIT_SLEEP 10
+#define SIM_EXIT_RESTART 11
+#define SIM_EXIT_END 12
+
+// Button events (OneButtonTiny callbacks)
+#define SIM_BTN_NONE 0
+#define SIM_BTN_CLICK 1
+#define SIM_BTN_DOUBLE 2
+#define SIM_BTN_LONG 3
+
+struct SimMsg
+{
+    char Topic[SIM_TOPIC_LEN];
+    char Payload[SIM_MSG_LEN];
+    uint16_t Len;
+    uint64_t AtUs; // arrival time at the device
+};
+
+struct SimNvsEntry
+{
+    char Ns[16];
+    char Key[16];
+    uint16_t Len;
+    uint8_t Data[SIM_NVS_LEN];
+};
+
+struct SimStats
+{
+    uint32_t Boots[3];      // power-on, DeepSleep wakeup, restart
+    uint32_t ButtonWakeups; // DeepSleep wakeups by button (ext0)
+    uint64_t AwakeUs;
+    uint64_t RadioUs;
+    uint64_t LedUs;         // LED ring powered
+    uint32_t WifiSessions;
+    uint32_t MqttConnects;
+    uint32_t RoundTrips;    // CONNECT and SUBSCRIBE exchanges the device waited for
+    uint32_t MsgsRcvd;      // messages delivered to the device
+    uint32_t MsgsSent;      // messages published by the device
+    uint32_t MsgsDropped;   // delivery queue overflows
+    uint32_t FullRefresh;
+    uint32_t PartialRefresh;
+    uint32_t LedFrames;
+    uint32_t NvsWrites;
+    uint32_t NtpSyncs;
+    uint32_t FeederRuns;
+    uint32_t NewEvents;     // events published by the feeder
+    uint32_t Clicks;        // single clicks (snooze) by the user
+    uint32_t Acks;          // double clicks (acknowledge) by the user
+    uint32_t AcksPublished; // acknowledges that reached the broker
+    uint32_t AckLatMs[SIM_ACK_HIST];
+};
+
+// State shared between the simulator and all simulated boots (survives the firmware process)
+struct SimState
+{
+    // Virtual time
+    uint64_t NowUs;      // time since start of the simulation
+    uint64_t EndUs;
+    int64_t StartEpoch;  // true epoch at start of the simulation
+    uint64_t LoopUs;
+    uint32_t Rng;        // network jitter
+    int JitterPct;
+    bool Bench;          // benchmark instead of calendar scenario (sim-bench.cpp)
+    // Running firmware instance
+    uint64_t BootUs;       // NowUs at boot
+    int64_t SysOffsetUs;   // device system time = NowUs + SysOffsetUs
+    int ResetReason;       // esp_reset_reason_t
+    int WakeCause;         // esp_sleep_source_t
+    bool InDevice;         // running in the firmware process
+    uint32_t BootRoundTrips; // Stats.RoundTrips at boot
+    // DeepSleep configuration
+    uint64_t TimerWakeUs;  // 0 = no timer wakeup
+    bool Ext0Armed;
+    bool RtcSlowMemOff;
+    // RTC memory images
+    bool RtcValid;
+    uint32_t RtcLen;
+    uint8_t Rtc[SIM_RTC_SIZE];
+    bool NoinitValid;
+    uint32_t NoinitLen;
+    uint8_t Noinit[SIM_RTC_SIZE];
+    // WiFi and NTP
+    bool RadioOn;
+    uint64_t RadioOnUs;
+    uint64_t AssocDoneUs;
+    uint64_t WifiConnectUs;
+    bool SntpRunning;
+    uint64_t SntpNextUs;
+    uint64_t SntpIntervalUs;
+    // Broker
+    uint64_t RttUs;
+    int RetainedCnt;
+    SimMsg Retained[SIM_RETAINED];
+    bool Session; // device connected to the broker
+    int SubCnt;
+    char Subs[SIM_SUBS][SIM_TOPIC_LEN];
+    uint32_t QHead;
+    uint32_t QTail;
+    SimMsg Queue[SIM_QUEUE];
+    // NVS
+    SimNvsEntry Nvs[SIM_NVS_ENTRIES];
+    // Peripherals
+    bool LedPower;
+    uint64_t LedOnUs;
+    int BtnEvent;
+    uint64_t BtnDueUs;
+    uint64_t AckClickUs; // acknowledge not yet published (0 = none)
+    bool Verbose;
+    SimStats Stats;
+};
+
+extern SimState *Sim;
+
+// Virtual time
+extern void SimAdvance(uint64_t Us);
+extern uint64_t SimUptimeUs();
+extern int64_t SimEpochUs();  // device system time
+extern uint32_t SimRand();
+extern uint64_t SimJitter(uint64_t Us);  // Us +/- JitterPct
+// Leave the firmware process (DeepSleep, restart or end of simulation)
+[[noreturn]] extern void SimDeviceExit(int Code);
+
+// FreeRTOS tasks (sim-hal.cpp)
+extern uint64_t SimTasksNextUs();
+extern void SimTasksRun();
+
+// Peripherals (sim-periph.cpp)
+extern void SimPinWrite(int Pin, int Val);
+extern int SimPinRead(int Pin);
+extern void SimSerialWrite(const uint8_t *Buf, size_t Len);
+extern void SimLedShow(int Leds);
+extern void SimEpdRefresh(bool Partial);
+extern int SimButtonTake();
+extern SimNvsEntry *SimNvsFind(const char *Ns, const char *Key, bool Create);
+
+// Network (sim-net.cpp)
+extern void SimWifiBegin();
+extern bool SimWifiConnected();
+extern void SimWifiOff();
+extern bool SimMqttConnect();
+extern void SimMqttDisconnect();
+extern bool SimMqttSubscribe(const char *Filter);
+extern bool SimMqttPoll(SimMsg *Msg);
+extern void SimBrokerPublish(const char *Topic, const char *Payload, size_t Len, bool Retained, bool FromDevice);
+extern const char *SimBrokerRetained(const char *Topic);
+extern void SimSntpStart();
+extern void SimSntpStop();
+extern void SimSntpHandle();
+extern void SimSntpSetCallback(void (*Cb)(struct timeval *));
+
+// Scenario (sim-scenario.cpp)
+extern void SimScenarioInit(uint32_t Seed, int SnoozePercent);
+extern uint64_t SimScenarioNextUs();
+extern void SimScenarioRun();
+extern void SimScenarioPublished(const char *Topic, const char *Payload); // message published by the device
+extern void SimBrokerSeed();
+extern void SimFeederPublishEvent(const char *Txt, const char *Reminder, const char *Status, int64_t Now);
+
+// Benchmark (sim-bench.cpp)
+extern void SimBenchInit(int Iterations);
+extern uint64_t SimBenchNextUs();
+extern void SimBenchRun();
+extern void SimBenchProbe();
+extern void SimBenchReport();
+
+#endif // SIM_HOST_H
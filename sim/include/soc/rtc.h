@@ -0,0 +1,33 @@
+/*
+ *   ESP32 Rememberall
+ *   Host simulator: RTC clock stand-in
+ */
+#ifndef SOC_RTC_H
+#define SOC_RTC_H
+
+#include <stdint.h>
+
+// The simulated RTC is ideal, calibration values are accepted and ignored
+typedef enum
+{
+    RTC_SLOW_FREQ_RTC,
+    RTC_SLOW_FREQ_32K_XTAL,
+    RTC_SLOW_FREQ_8MD256,
+} rtc_slow_freq_t;
+
+typedef enum
+{
+    RTC_CAL_RTC_MUX,
+    RTC_CAL_8MD256,
+    RTC_CAL_32K_XTAL,
+} rtc_cal_sel_t;
+
+#define RTC_CNTL_STORE1_REG 0
+#define REG_WRITE(Reg, Val) ((void)(Reg), (void)(Val))
+#define REG_READ(Reg) ((uint32_t)0)
+
+uint32_t rtc_clk_cal(rtc_cal_sel_t Clk, uint32_t Cycles);
+void rtc_clk_8m_enable(bool ClkEnable, bool D256Enable = false);
+void rtc_clk_slow_freq_set(rtc_slow_freq_t Freq);
+
+#endif // SOC_RTC_H
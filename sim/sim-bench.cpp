@@ -0,0 +1,220 @@
+/*
+ * ESP32 Rememberall
+ * Host simulator: latency benchmark of the MQTT and decode path
+ *
+ * Replays the publish sequence of the feeder (eventTxt, eventReminder, Status, Manifest, SleepUntil) and measures
+ * the time until the firmware has decoded the event into LocalEventInfo:
+ * - Wakeup: event published while the Rememberall sleeps, measured from the DeepSleep wakeup
+ *   (WiFi association, broker connect, subscriptions and WAIT_FOR_SUBSCRIPTIONS)
+ * - Push: event published while the Rememberall is awake (SleepUntil "0"), measured from the first publish
+ */
+#include <sys/mman.h>
+#include "setup.h"
+#include "payload-codec.h"
+#include "sim-host.h"
+
+extern eventInfoStruct LocalEventInfo;
+
+#define BENCH_MAX 1000
+#define BENCH_WAKE_PERIOD_S 900     // DeepSleep period of the wakeup phase
+#define BENCH_WAKE_LEAD_S 60        // events are published this long before the wakeup
+#define BENCH_PUSH_MIN_S 600        // random interval between publishes of the push phase
+#define BENCH_PUSH_MAX_S 2400
+#define BENCH_DEADLINE_S (12 * 3600) // deadline of the published events
+
+enum
+{
+    BENCH_WAKE,
+    BENCH_PUSH,
+    BENCH_DONE
+};
+
+struct SimBenchState
+{
+    int Iterations;
+    int Phase;
+    int Seq;          // events published
+    uint64_t NextUs;  // next publish
+    // event waiting to be decoded
+    bool Waiting;
+    int64_t Deadline;
+    char Tag[16];
+    uint64_t PubUs;
+    uint32_t PubRoundTrips;
+    // results
+    int WakeCnt;
+    int PushCnt;
+    int Skipped; // decoded, but not in the measured situation (e.g. awake when publishing in the wakeup phase)
+    int Missed;  // not decoded before the next publish
+    int WakeLost; // Skipped and Missed of the wakeup phase
+    uint64_t WakeUs[BENCH_MAX];
+    uint32_t WakeRt[BENCH_MAX];
+    uint64_t PushUs[BENCH_MAX];
+    uint32_t PushRt[BENCH_MAX];
+};
+static SimBenchState *Bench = NULL;
+
+static int64_t BenchNow()
+{
+    return Sim->StartEpoch + (int64_t)(Sim->NowUs / 1000000ULL);
+}
+
+static void BenchPublish(const char *SleepUntil)
+{
+    int64_t Now = BenchNow();
+    if (Bench->Waiting)
+    {
+        Bench->Missed++;
+    }
+    Bench->Seq++;
+    Bench->Deadline = Now + BENCH_DEADLINE_S;
+    snprintf(Bench->Tag, sizeof(Bench->Tag), "#%d", Bench->Seq);
+    char Txt[40], Reminder[60];
+    PayloadTxt Lines = {2, 1, {1, 1}, {"Bench", Bench->Tag}, {5, (uint8_t)strlen(Bench->Tag)}};
+    PayloadEncodeTxt(&Lines, Txt, sizeof(Txt));
+    PayloadReminder Rem = {Bench->Deadline, Bench->Deadline - 24 * 3600, Bench->Deadline - 12 * 3600, 0x00FF00};
+    PayloadEncodeReminder(&Rem, Reminder, sizeof(Reminder));
+    Bench->PubUs = Sim->NowUs;
+    Bench->PubRoundTrips = Sim->Stats.RoundTrips;
+    Bench->Waiting = true;
+    SimFeederPublishEvent(Txt, Reminder, "newEvent", Now);
+    SimBrokerPublish(sleep_until_topic, SleepUntil, strlen(SleepUntil), true, false);
+}
+
+void SimBenchInit(int Iterations)
+{
+    Bench = (SimBenchState *)mmap(NULL, sizeof(SimBenchState), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (Bench == MAP_FAILED)
+    {
+        perror("mmap");
+        exit(1);
+    }
+    memset(Bench, 0, sizeof(SimBenchState));
+    Bench->Iterations = min(Iterations, BENCH_MAX);
+    Sim->Bench = true;
+    SimBrokerSeed();
+    // first event is received at power-on (not measured)
+    Bench->Phase = BENCH_WAKE;
+    Bench->NextUs = 0;
+}
+
+uint64_t SimBenchNextUs()
+{
+    return Bench->NextUs;
+}
+
+void SimBenchRun()
+{
+    if (Sim->NowUs < Bench->NextUs)
+    {
+        return;
+    }
+    char SleepUntil[20];
+    switch (Bench->Phase)
+    {
+    case BENCH_WAKE:
+        if (Bench->WakeCnt + Bench->Skipped + Bench->Missed < Bench->Iterations)
+        {
+            // wake up BENCH_WAKE_LEAD_S after the next publish
+            Bench->NextUs = Sim->NowUs + BENCH_WAKE_PERIOD_S * 1000000ULL;
+            snprintf(SleepUntil, sizeof(SleepUntil), "%lx", (unsigned long)(BenchNow() + BENCH_WAKE_PERIOD_S + BENCH_WAKE_LEAD_S));
+            BenchPublish(SleepUntil);
+            if (Bench->Seq == 1)
+            {
+                // power-on boot
+                Bench->NextUs -= BENCH_WAKE_LEAD_S * 1000000ULL;
+            }
+            break;
+        }
+        // stay awake from the next wakeup on
+        Bench->Phase = BENCH_PUSH;
+        Bench->WakeLost = Bench->Skipped + Bench->Missed;
+        Bench->Missed = 0;
+        Bench->Skipped = 0;
+        Bench->NextUs = Sim->NowUs + BENCH_WAKE_PERIOD_S * 1000000ULL;
+        BenchPublish("0");
+        Bench->Waiting = false;
+        break;
+    case BENCH_PUSH:
+        if (Bench->PushCnt + Bench->Missed < Bench->Iterations)
+        {
+            Bench->NextUs = Sim->NowUs + (BENCH_PUSH_MIN_S + SimRand() % (BENCH_PUSH_MAX_S - BENCH_PUSH_MIN_S)) * 1000000ULL;
+            BenchPublish("0");
+            break;
+        }
+        Bench->Phase = BENCH_DONE;
+        Bench->NextUs = UINT64_MAX;
+        Sim->EndUs = Sim->NowUs;
+        break;
+    }
+}
+
+// Called in the firmware process whenever the virtual time advances
+void SimBenchProbe()
+{
+    if (!Bench->Waiting || LocalEventInfo.Deadline != Bench->Deadline || strcmp(LocalEventInfo.TextLines[1], Bench->Tag) != 0)
+    {
+        return;
+    }
+    Bench->Waiting = false;
+    if (Bench->Phase == BENCH_PUSH)
+    {
+        Bench->PushUs[Bench->PushCnt] = Sim->NowUs - Bench->PubUs;
+        Bench->PushRt[Bench->PushCnt] = Sim->Stats.RoundTrips - Bench->PubRoundTrips;
+        Bench->PushCnt++;
+    }
+    else if (Bench->Seq > 1 && Sim->ResetReason == ESP_RST_DEEPSLEEP && Bench->PubUs < Sim->BootUs)
+    {
+        Bench->WakeUs[Bench->WakeCnt] = Sim->NowUs - Sim->BootUs;
+        Bench->WakeRt[Bench->WakeCnt] = Sim->Stats.RoundTrips - Sim->BootRoundTrips;
+        Bench->WakeCnt++;
+    }
+    else if (Bench->Seq > 1)
+    {
+        Bench->Skipped++;
+    }
+}
+
+static int BenchCmpU64(const void *A, const void *B)
+{
+    uint64_t X = *(const uint64_t *)A, Y = *(const uint64_t *)B;
+    return (X > Y) - (X < Y);
+}
+
+static int BenchCmpU32(const void *A, const void *B)
+{
+    uint32_t X = *(const uint32_t *)A, Y = *(const uint32_t *)B;
+    return (X > Y) - (X < Y);
+}
+
+// Nearest rank percentile of sorted values
+static int BenchRank(int Cnt, int Pct)
+{
+    int Rank = (Cnt * Pct + 99) / 100;
+    return (Rank > 0) ? Rank - 1 : 0;
+}
+
+static void BenchPrint(const char *Name, uint64_t *Us, uint32_t *Rt, int Cnt)
+{
+    if (Cnt == 0)
+    {
+        printf("  %-8s no samples\n", Name);
+        return;
+    }
+    qsort(Us, Cnt, sizeof(uint64_t), BenchCmpU64);
+    qsort(Rt, Cnt, sizeof(uint32_t), BenchCmpU32);
+    printf("  %-8s %4d samples, time to decoded event p50 %9.1f ms  p99 %9.1f ms  max %9.1f ms, round trips p50 %u  p99 %u\n", Name, Cnt,
+           Us[BenchRank(Cnt, 50)] / 1e3, Us[BenchRank(Cnt, 99)] / 1e3, Us[Cnt - 1] / 1e3, Rt[BenchRank(Cnt, 50)], Rt[BenchRank(Cnt, 99)]);
+}
+
+void SimBenchReport()
+{
+    printf("  Broker round trip %.1f ms, WiFi connect %.0f ms, jitter %d %%\n", Sim->RttUs / 1e3, Sim->WifiConnectUs / 1e3, Sim->JitterPct);
+    BenchPrint("Wakeup", Bench->WakeUs, Bench->WakeRt, Bench->WakeCnt);
+    BenchPrint("Push", Bench->PushUs, Bench->PushRt, Bench->PushCnt);
+    if (Bench->WakeLost > 0 || Bench->Missed > 0)
+    {
+        printf("  Not measured: %d wakeup events (decoded while awake or not before the next publish), %d push events (not decoded before the next publish)\n",
+               Bench->WakeLost, Bench->Missed);
+    }
+}
@@ -0,0 +1,412 @@
+/*
+ * ESP32 Rememberall
+ * Host simulator: Arduino core and ESP-IDF stand-ins
+ */
+#include <Arduino.h>
+#include <ArduinoOTA.h>
+#include <WiFi.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdarg.h>
+#include "esp_timer.h"
+#include "esp_sntp.h"
+#include "esp_pm.h"
+#include "soc/rtc.h"
+#include "driver/rtc_io.h"
+#include "hardware-config.h"
+#include "sim-host.h"
+
+HardwareSerial Serial;
+EspClass ESP;
+ArduinoOTAClass ArduinoOTA;
+WiFiClass WiFi;
+
+//
+// Time
+//
+unsigned long millis()
+{
+    return (unsigned long)(SimUptimeUs() / 1000ULL);
+}
+
+unsigned long micros()
+{
+    return (unsigned long)SimUptimeUs();
+}
+
+int64_t esp_timer_get_time()
+{
+    return (int64_t)SimUptimeUs();
+}
+
+void delay(uint32_t Ms)
+{
+    SimAdvance((uint64_t)Ms * 1000ULL);
+}
+
+void delayMicroseconds(uint32_t Us)
+{
+    SimAdvance(Us);
+}
+
+void yield()
+{
+}
+
+time_t SimTime(time_t *Timer)
+{
+    time_t Now = (time_t)(SimEpochUs() / 1000000LL);
+    if (Timer)
+    {
+        *Timer = Now;
+    }
+    return Now;
+}
+
+int SimGettimeofday(struct timeval *Tv, void *Tz)
+{
+    int64_t Us = SimEpochUs();
+    Tv->tv_sec = (time_t)(Us / 1000000LL);
+    Tv->tv_usec = (suseconds_t)(Us % 1000000LL);
+    return 0;
+}
+
+void configTzTime(const char *Tz, const char *Server1, const char *Server2, const char *Server3)
+{
+    setenv("TZ", Tz, 1);
+    tzset();
+    SimSntpStart();
+}
+
+bool getLocalTime(struct tm *Info, uint32_t Ms)
+{
+    time_t Now = time(NULL);
+    localtime_r(&Now, Info);
+    return Info->tm_year > (2016 - 1900);
+}
+
+void sntp_set_time_sync_notification_cb(void (*Cb)(struct timeval *Tv))
+{
+    SimSntpSetCallback(Cb);
+}
+
+void sntp_set_sync_mode(int Mode)
+{
+}
+
+void sntp_set_sync_interval(uint32_t IntervalMs)
+{
+    Sim->SntpIntervalUs = (uint64_t)IntervalMs * 1000ULL;
+}
+
+void sntp_stop()
+{
+    SimSntpStop();
+}
+
+//
+// GPIO, ADC and system
+//
+void pinMode(uint8_t Pin, uint8_t Mode)
+{
+}
+
+void digitalWrite(uint8_t Pin, uint8_t Val)
+{
+    SimPinWrite(Pin, Val);
+}
+
+int digitalRead(uint8_t Pin)
+{
+    return SimPinRead(Pin);
+}
+
+uint16_t analogRead(uint8_t Pin)
+{
+    return (uint16_t)(SIM_VCC / (VDIV * VFULL_SCALE) * ADC_MAXVAL);
+}
+
+uint32_t analogReadMilliVolts(uint8_t Pin)
+{
+    return (uint32_t)(SIM_VCC / VDIV * 1000.0f);
+}
+
+void analogReadResolution(uint8_t Bits)
+{
+}
+
+void analogSetPinAttenuation(uint8_t Pin, int Attenuation)
+{
+}
+
+int8_t digitalPinToAnalogChannel(uint8_t Pin)
+{
+    return (int8_t)Pin;
+}
+
+float temperatureRead()
+{
+    return 25.0f;
+}
+
+static uint32_t SimCpuMhz = 240;
+
+bool setCpuFrequencyMhz(uint32_t Mhz)
+{
+    SimCpuMhz = Mhz;
+    return true;
+}
+
+uint32_t getCpuFrequencyMhz()
+{
+    return SimCpuMhz;
+}
+
+#if defined __GLIBC__ && (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38)
+size_t strlcpy(char *Dst, const char *Src, size_t Size)
+{
+    size_t Len = strlen(Src);
+    if (Size > 0)
+    {
+        size_t Copy = (Len >= Size) ? Size - 1 : Len;
+        memcpy(Dst, Src, Copy);
+        Dst[Copy] = '\0';
+    }
+    return Len;
+}
+#endif
+
+size_t Print::printf(const char *Fmt, ...)
+{
+    char Buf[256];
+    va_list Args;
+    va_start(Args, Fmt);
+    int Len = vsnprintf(Buf, sizeof(Buf), Fmt, Args);
+    va_end(Args);
+    if (Len < 0)
+    {
+        return 0;
+    }
+    return write((const uint8_t *)Buf, ((size_t)Len < sizeof(Buf)) ? (size_t)Len : sizeof(Buf) - 1);
+}
+
+size_t HardwareSerial::write(uint8_t C)
+{
+    SimSerialWrite(&C, 1);
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *Buf, size_t Len)
+{
+    SimSerialWrite(Buf, Len);
+    return Len;
+}
+
+void EspClass::restart()
+{
+    SimDeviceExit(SIM_EXIT_RESTART);
+}
+
+uint32_t EspClass::getFreeHeap()
+{
+    return 200000;
+}
+
+uint32_t EspClass::getMinFreeHeap()
+{
+    return 180000;
+}
+
+uint32_t EspClass::getMaxAllocHeap()
+{
+    return 110000;
+}
+
+uint32_t EspClass::getHeapSize()
+{
+    return 280000;
+}
+
+uint64_t EspClass::getEfuseMac()
+{
+    return 0x0000A1B2C3D4E5F6ULL;
+}
+
+esp_reset_reason_t esp_reset_reason()
+{
+    return (esp_reset_reason_t)Sim->ResetReason;
+}
+
+esp_err_t esp_wifi_set_config(wifi_interface_t Interface, wifi_config_t *Config)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_pm_configure(const void *Config)
+{
+    return ESP_OK;
+}
+
+//
+// DeepSleep and RTC
+//
+esp_err_t esp_sleep_pd_config(esp_sleep_pd_domain_t Domain, esp_sleep_pd_option_t Option)
+{
+    if (Domain == ESP_PD_DOMAIN_RTC_SLOW_MEM)
+    {
+        Sim->RtcSlowMemOff = (Option == ESP_PD_OPTION_OFF);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t Us)
+{
+    Sim->TimerWakeUs = Us;
+    return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_ext0_wakeup(gpio_num_t Pin, int Level)
+{
+    Sim->Ext0Armed = true;
+    return ESP_OK;
+}
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause()
+{
+    return (esp_sleep_wakeup_cause_t)Sim->WakeCause;
+}
+
+void esp_deep_sleep(uint64_t Us)
+{
+    esp_sleep_enable_timer_wakeup(Us);
+    esp_deep_sleep_start();
+}
+
+void esp_deep_sleep_start()
+{
+    SimDeviceExit(SIM_EXIT_SLEEP);
+}
+
+uint32_t rtc_clk_cal(rtc_cal_sel_t Clk, uint32_t Cycles)
+{
+    // 150kHz slow clock period in microseconds (Q13.19)
+    return 3495253;
+}
+
+void rtc_clk_8m_enable(bool ClkEnable, bool D256Enable)
+{
+}
+
+void rtc_clk_slow_freq_set(rtc_slow_freq_t Freq)
+{
+}
+
+esp_err_t rtc_gpio_pullup_en(gpio_num_t Pin)
+{
+    return ESP_OK;
+}
+
+esp_err_t rtc_gpio_pulldown_dis(gpio_num_t Pin)
+{
+    return ESP_OK;
+}
+
+esp_err_t rtc_gpio_hold_en(gpio_num_t Pin)
+{
+    return ESP_OK;
+}
+
+esp_err_t rtc_gpio_hold_dis(gpio_num_t Pin)
+{
+    return ESP_OK;
+}
+
+//
+// FreeRTOS
+//
+// Tasks run in lockstep with the virtual time: the main thread hands over at the wakeup time of a task
+// and waits until the task blocks in vTaskDelay again
+#define SIM_TASKS 4
+struct SimTask
+{
+    void (*Fn)(void *);
+    void *Param;
+    uint64_t WakeUs;
+    sem_t Run;
+    sem_t Done;
+};
+static SimTask SimTasks[SIM_TASKS];
+static int SimTaskCnt = 0;
+static thread_local SimTask *SimTaskSelf = NULL;
+
+static void *SimTaskRun(void *Arg)
+{
+    SimTaskSelf = (SimTask *)Arg;
+    sem_wait(&SimTaskSelf->Run);
+    SimTaskSelf->Fn(SimTaskSelf->Param);
+    // task returned, never wake it again
+    SimTaskSelf->WakeUs = UINT64_MAX;
+    sem_post(&SimTaskSelf->Done);
+    return NULL;
+}
+
+uint64_t SimTasksNextUs()
+{
+    uint64_t Next = UINT64_MAX;
+    for (int i = 0; i < SimTaskCnt; i++)
+    {
+        Next = min(Next, SimTasks[i].WakeUs);
+    }
+    return Next;
+}
+
+void SimTasksRun()
+{
+    for (int i = 0; i < SimTaskCnt; i++)
+    {
+        if (SimTasks[i].WakeUs <= Sim->NowUs)
+        {
+            sem_post(&SimTasks[i].Run);
+            sem_wait(&SimTasks[i].Done);
+        }
+    }
+}
+
+BaseType_t xTaskCreate(void (*Task)(void *), const char *Name, uint32_t StackDepth, void *Param, UBaseType_t Priority, TaskHandle_t *Handle)
+{
+    if (SimTaskCnt >= SIM_TASKS)
+    {
+        return pdFALSE;
+    }
+    SimTask *T = &SimTasks[SimTaskCnt];
+    T->Fn = Task;
+    T->Param = Param;
+    T->WakeUs = Sim->NowUs;
+    sem_init(&T->Run, 0, 0);
+    sem_init(&T->Done, 0, 0);
+    pthread_t Thread;
+    if (pthread_create(&Thread, NULL, SimTaskRun, T) != 0)
+    {
+        return pdFALSE;
+    }
+    pthread_detach(Thread);
+    SimTaskCnt++;
+    return pdPASS;
+}
+
+void vTaskDelay(TickType_t Ticks)
+{
+    if (!SimTaskSelf)
+    {
+        delay(Ticks * portTICK_PERIOD_MS);
+        return;
+    }
+    SimTaskSelf->WakeUs = Sim->NowUs + (uint64_t)Ticks * portTICK_PERIOD_MS * 1000ULL;
+    sem_post(&SimTaskSelf->Done);
+    sem_wait(&SimTaskSelf->Run);
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t Task)
+{
+    return 4096;
+}
@@ -0,0 +1,341 @@
+/*
+ * ESP32 Rememberall
+ * Host simulator: virtual time, boot/DeepSleep process model and report
+ *
+ * Every boot of the firmware runs in a forked process, so all variables except RTC memory start over
+ * like on the ESP. The simulator state (virtual time, broker, NVS, RTC memory images) lives in shared memory.
+ */
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "setup.h"
+#include "sim-host.h"
+
+extern void loop();
+
+SimState *Sim = NULL;
+
+// Section bounds provided by the linker; the markers make sure both sections exist
+extern "C" uint8_t __start_rtcsim_data[], __stop_rtcsim_data[];
+extern "C" uint8_t __start_rtcsim_noinit[], __stop_rtcsim_noinit[];
+__attribute__((used)) RTC_DATA_ATTR uint32_t SimRtcMarker = 0;
+__attribute__((used)) RTC_NOINIT_ATTR uint32_t SimNoinitMarker;
+
+static const char *BootNames[] = {"power-on", "DeepSleep wakeup", "restart"};
+
+uint64_t SimUptimeUs()
+{
+    return Sim->NowUs - Sim->BootUs;
+}
+
+int64_t SimEpochUs()
+{
+    return (int64_t)Sim->NowUs + Sim->SysOffsetUs;
+}
+
+uint32_t SimRand()
+{
+    // xorshift32
+    Sim->Rng ^= Sim->Rng << 13;
+    Sim->Rng ^= Sim->Rng >> 17;
+    Sim->Rng ^= Sim->Rng << 5;
+    return Sim->Rng;
+}
+
+uint64_t SimJitter(uint64_t Us)
+{
+    if (Sim->JitterPct <= 0)
+    {
+        return Us;
+    }
+    int Pct = 100 + (int)(SimRand() % (uint32_t)(2 * Sim->JitterPct + 1)) - Sim->JitterPct;
+    return Us * (uint64_t)Pct / 100ULL;
+}
+
+void SimAdvance(uint64_t Us)
+{
+    uint64_t Target = Sim->NowUs + Us;
+    do
+    {
+        uint64_t Next = min(Target, SimScenarioNextUs());
+        if (Sim->InDevice)
+        {
+            Next = min(Next, SimTasksNextUs());
+            if (Sim->SntpRunning)
+            {
+                Next = min(Next, Sim->SntpNextUs);
+            }
+        }
+        Next = min(Next, Sim->EndUs);
+        if (Next > Sim->NowUs)
+        {
+            Sim->NowUs = Next;
+        }
+        SimScenarioRun();
+        if (!Sim->InDevice)
+        {
+            if (Sim->NowUs >= Sim->EndUs)
+            {
+                return;
+            }
+            continue;
+        }
+        SimSntpHandle();
+        SimTasksRun();
+        if (Sim->Bench)
+        {
+            SimBenchProbe();
+        }
+        if (Sim->NowUs >= Sim->EndUs)
+        {
+            SimDeviceExit(SIM_EXIT_END);
+        }
+    } while (Sim->NowUs < Target);
+}
+
+void SimDeviceExit(int Code)
+{
+    fflush(stdout);
+    Sim->Stats.AwakeUs += Sim->NowUs - Sim->BootUs;
+    SimWifiOff();
+    SimPinWrite(EMB_PWS_U2, LOW);
+    Sim->InDevice = false;
+    size_t Len = (size_t)(__stop_rtcsim_data - __start_rtcsim_data);
+    Sim->RtcValid = (Code == SIM_EXIT_SLEEP) && !Sim->RtcSlowMemOff && Len <= SIM_RTC_SIZE;
+    if (Sim->RtcValid)
+    {
+        memcpy(Sim->Rtc, __start_rtcsim_data, Len);
+        Sim->RtcLen = (uint32_t)Len;
+    }
+    Len = (size_t)(__stop_rtcsim_noinit - __start_rtcsim_noinit);
+    Sim->NoinitValid = Len <= SIM_RTC_SIZE;
+    if (Sim->NoinitValid)
+    {
+        memcpy(Sim->Noinit, __start_rtcsim_noinit, Len);
+        Sim->NoinitLen = (uint32_t)Len;
+    }
+    _exit(Code);
+}
+
+// Runs in the forked firmware process
+[[noreturn]] static void SimBoot()
+{
+    if (Sim->RtcValid && Sim->RtcLen == (uint32_t)(__stop_rtcsim_data - __start_rtcsim_data))
+    {
+        memcpy(__start_rtcsim_data, Sim->Rtc, Sim->RtcLen);
+    }
+    if (Sim->NoinitValid && Sim->NoinitLen == (uint32_t)(__stop_rtcsim_noinit - __start_rtcsim_noinit))
+    {
+        memcpy(__start_rtcsim_noinit, Sim->Noinit, Sim->NoinitLen);
+    }
+    Sim->InDevice = true;
+    Sim->BootUs = Sim->NowUs;
+    Sim->BootRoundTrips = Sim->Stats.RoundTrips;
+    Sim->TimerWakeUs = 0;
+    Sim->Ext0Armed = false;
+    Sim->RtcSlowMemOff = false;
+    Sim->SntpRunning = false;
+    Sim->BtnEvent = SIM_BTN_NONE;
+    setup();
+    for (;;)
+    {
+        loop();
+        SimAdvance(Sim->LoopUs);
+    }
+}
+
+static void SimUsage(const char *Name)
+{
+    fprintf(stderr, "Usage: %s [--days N] [--seed N] [--snooze PERCENT] [--loop-us US] [--rtt-ms MS] [--jitter PERCENT] [--bench N] [-v]\n", Name);
+    exit(2);
+}
+
+static int SimCmpU32(const void *A, const void *B)
+{
+    uint32_t X = *(const uint32_t *)A, Y = *(const uint32_t *)B;
+    return (X > Y) - (X < Y);
+}
+
+static void SimReport(double HostSec, int Days)
+{
+    SimStats *S = &Sim->Stats;
+    double SimSec = Sim->NowUs / 1e6;
+    printf("\nSimulated %d days in %.2f s host time\n", Days, HostSec);
+    for (int i = 0; i < 3; i++)
+    {
+        printf("  Boots (%s): %u\n", BootNames[i], S->Boots[i]);
+    }
+    printf("  Button wakeups:    %u\n", S->ButtonWakeups);
+    printf("  Awake:             %.0f s (%.2f %%)\n", S->AwakeUs / 1e6, 100.0 * S->AwakeUs / 1e6 / SimSec);
+    printf("  Radio on:          %.0f s in %u WiFi sessions\n", S->RadioUs / 1e6, S->WifiSessions);
+    printf("  MQTT:              %u connects, %u round trips, %u messages received, %u sent, %u dropped\n", S->MqttConnects, S->RoundTrips,
+           S->MsgsRcvd, S->MsgsSent, S->MsgsDropped);
+    printf("  NTP syncs:         %u\n", S->NtpSyncs);
+    printf("  ePaper refreshes:  %u full, %u partial\n", S->FullRefresh, S->PartialRefresh);
+    printf("  LED ring:          %.0f s on, %u frames\n", S->LedUs / 1e6, S->LedFrames);
+    printf("  NVS writes:        %u\n", S->NvsWrites);
+    printf("  Feeder:            %u runs, %u new events\n", S->FeederRuns, S->NewEvents);
+    printf("  User:              %u snoozes, %u acknowledges, %u published\n", S->Clicks, S->Acks, S->AcksPublished);
+    uint32_t Cnt = min(S->AcksPublished, (uint32_t)SIM_ACK_HIST);
+    if (Cnt > 0)
+    {
+        qsort(S->AckLatMs, Cnt, sizeof(uint32_t), SimCmpU32);
+        printf("  Ack latency:       median %.1f s, max %.1f s\n", S->AckLatMs[Cnt / 2] / 1e3, S->AckLatMs[Cnt - 1] / 1e3);
+    }
+    if (Sim->AckClickUs != 0)
+    {
+        printf("  Ack pending since  %.0f s\n", (Sim->NowUs - Sim->AckClickUs) / 1e6);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int Days = 7;
+    uint32_t Seed = 1;
+    int Snooze = 20;
+    uint64_t LoopUs = SIM_LOOP_US;
+    uint64_t RttMs = SIM_BROKER_RTT_MS;
+    int Jitter = SIM_JITTER_PCT;
+    int Bench = 0;
+    bool Verbose = false;
+    for (int i = 1; i < argc; i++)
+    {
+        bool HasVal = (i + 1 < argc);
+        if (strcmp(argv[i], "--days") == 0 && HasVal)
+            Days = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && HasVal)
+            Seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "--snooze") == 0 && HasVal)
+            Snooze = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--loop-us") == 0 && HasVal)
+            LoopUs = strtoull(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "--rtt-ms") == 0 && HasVal)
+            RttMs = strtoull(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "--jitter") == 0 && HasVal)
+            Jitter = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--bench") == 0 && HasVal)
+            Bench = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-v") == 0)
+            Verbose = true;
+        else
+            SimUsage(argv[0]);
+    }
+    if (Days <= 0 || LoopUs == 0 || Jitter < 0 || Jitter > 100 || Bench < 0)
+    {
+        SimUsage(argv[0]);
+    }
+
+    Sim = (SimState *)mmap(NULL, sizeof(SimState), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (Sim == MAP_FAILED)
+    {
+        perror("mmap");
+        return 1;
+    }
+    memset(Sim, 0, sizeof(SimState));
+    Sim->LoopUs = LoopUs;
+    Sim->RttUs = RttMs * 1000ULL;
+    Sim->WifiConnectUs = SIM_WIFI_CONNECT_MS * 1000ULL;
+    Sim->EndUs = (uint64_t)Days * 86400ULL * 1000000ULL;
+    Sim->Verbose = Verbose;
+    Sim->Rng = Seed ? Seed : 1;
+    Sim->JitterPct = Jitter;
+    if (Bench > 0)
+    {
+        // runs until all iterations are done
+        Sim->EndUs = 365ULL * 86400ULL * 1000000ULL;
+    }
+
+    // Start on a Monday at midnight local time
+    setenv("TZ", TIMEZONE, 1);
+    tzset();
+    struct tm Start = {};
+    Start.tm_year = 2026 - 1900;
+    Start.tm_mon = 2;
+    Start.tm_mday = 2;
+    Start.tm_isdst = -1;
+    Sim->StartEpoch = (int64_t)mktime(&Start);
+    if (Bench > 0)
+    {
+        SimBenchInit(Bench);
+    }
+    else
+    {
+        SimScenarioInit(Seed, Snooze);
+    }
+
+    struct timespec HostStart, HostEnd;
+    clock_gettime(CLOCK_MONOTONIC, &HostStart);
+
+    // Batteries inserted a few seconds after the start, system time starts at 0
+    SimAdvance(5000000ULL);
+    Sim->SysOffsetUs = -(int64_t)Sim->NowUs;
+    Sim->ResetReason = ESP_RST_POWERON;
+    Sim->WakeCause = ESP_SLEEP_WAKEUP_UNDEFINED;
+    int BootType = 0;
+    while (Sim->NowUs < Sim->EndUs)
+    {
+        Sim->Stats.Boots[BootType]++;
+        fflush(stdout);
+        pid_t Pid = fork();
+        if (Pid < 0)
+        {
+            perror("fork");
+            return 1;
+        }
+        if (Pid == 0)
+        {
+            SimBoot();
+        }
+        int Status;
+        waitpid(Pid, &Status, 0);
+        int Code = WIFEXITED(Status) ? WEXITSTATUS(Status) : -1;
+        if (Code == SIM_EXIT_END)
+        {
+            break;
+        }
+        if (Code == SIM_EXIT_RESTART)
+        {
+            Sim->ResetReason = ESP_RST_SW;
+            Sim->WakeCause = ESP_SLEEP_WAKEUP_UNDEFINED;
+            BootType = 2;
+            continue;
+        }
+        if (Code != SIM_EXIT_SLEEP)
+        {
+            fprintf(stderr, "Firmware process failed (%s %d) at %.3f s\n", WIFEXITED(Status) ? "exit code" : "signal",
+                    WIFEXITED(Status) ? Code : WTERMSIG(Status), Sim->NowUs / 1e6);
+            return 1;
+        }
+
+        // DeepSleep until timer or button wakeup
+        uint64_t WakeUs = Sim->TimerWakeUs ? Sim->NowUs + Sim->TimerWakeUs : UINT64_MAX;
+        Sim->WakeCause = ESP_SLEEP_WAKEUP_UNDEFINED;
+        while (Sim->NowUs < Sim->EndUs)
+        {
+            if (Sim->Ext0Armed && Sim->BtnEvent != SIM_BTN_NONE)
+            {
+                Sim->WakeCause = ESP_SLEEP_WAKEUP_EXT0;
+                Sim->Stats.ButtonWakeups++;
+                break;
+            }
+            if (Sim->NowUs >= WakeUs)
+            {
+                Sim->WakeCause = ESP_SLEEP_WAKEUP_TIMER;
+                break;
+            }
+            SimAdvance(max(min(WakeUs, SimScenarioNextUs()), Sim->NowUs + 1) - Sim->NowUs);
+        }
+        Sim->ResetReason = ESP_RST_DEEPSLEEP;
+        BootType = 1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &HostEnd);
+    double HostSec = (HostEnd.tv_sec - HostStart.tv_sec) + (HostEnd.tv_nsec - HostStart.tv_nsec) / 1e9;
+    if (Bench > 0)
+    {
+        printf("\nBenchmark: %.1f days simulated in %.2f s host time\n", Sim->NowUs / 86400e6, HostSec);
+        SimBenchReport();
+        return 0;
+    }
+    SimReport(HostSec, Days);
+    return 0;
+}
@@ -0,0 +1,260 @@
+/*
+ * ESP32 Rememberall
+ * Host simulator: WiFi, NTP and MQTT broker
+ */
+#include <Arduino.h>
+#include "sim-host.h"
+
+static void (*SimSntpCb)(struct timeval *) = NULL;
+
+//
+// WiFi
+//
+void SimWifiBegin()
+{
+    if (!Sim->RadioOn)
+    {
+        Sim->RadioOn = true;
+        Sim->RadioOnUs = Sim->NowUs;
+        Sim->Stats.WifiSessions++;
+    }
+    Sim->AssocDoneUs = Sim->NowUs + SimJitter(Sim->WifiConnectUs);
+}
+
+bool SimWifiConnected()
+{
+    return Sim->RadioOn && Sim->NowUs >= Sim->AssocDoneUs;
+}
+
+void SimWifiOff()
+{
+    if (!Sim->RadioOn)
+    {
+        return;
+    }
+    Sim->Stats.RadioUs += Sim->NowUs - Sim->RadioOnUs;
+    Sim->RadioOn = false;
+    SimMqttDisconnect();
+}
+
+//
+// NTP
+//
+void SimSntpSetCallback(void (*Cb)(struct timeval *))
+{
+    SimSntpCb = Cb;
+}
+
+void SimSntpStart()
+{
+    Sim->SntpRunning = true;
+    Sim->SntpNextUs = Sim->NowUs + SIM_NTP_MS * 1000ULL;
+}
+
+void SimSntpStop()
+{
+    Sim->SntpRunning = false;
+}
+
+// Called from SimAdvance when SntpNextUs is due: the device clock is set to the true time
+void SimSntpHandle()
+{
+    if (!Sim->SntpRunning || Sim->NowUs < Sim->SntpNextUs)
+    {
+        return;
+    }
+    if (!SimWifiConnected())
+    {
+        Sim->SntpNextUs = Sim->NowUs + 15000000ULL;
+        return;
+    }
+    Sim->SysOffsetUs = Sim->StartEpoch * 1000000LL;
+    Sim->Stats.NtpSyncs++;
+    Sim->SntpNextUs = Sim->NowUs + (Sim->SntpIntervalUs ? Sim->SntpIntervalUs : 3600000000ULL);
+    if (SimSntpCb)
+    {
+        struct timeval Tv;
+        gettimeofday(&Tv, NULL);
+        SimSntpCb(&Tv);
+    }
+}
+
+//
+// MQTT broker
+//
+static bool SimTopicMatch(const char *Filter, const char *Topic)
+{
+    while (*Filter)
+    {
+        if (*Filter == '#')
+        {
+            return true;
+        }
+        if (*Filter == '+')
+        {
+            while (*Topic && *Topic != '/')
+            {
+                Topic++;
+            }
+            Filter++;
+            continue;
+        }
+        if (*Filter != *Topic)
+        {
+            return false;
+        }
+        Filter++;
+        Topic++;
+    }
+    return *Topic == '\0';
+}
+
+static void SimQueue(const SimMsg *Msg, uint64_t AtUs)
+{
+    if (Sim->QTail - Sim->QHead >= SIM_QUEUE)
+    {
+        Sim->Stats.MsgsDropped++;
+        return;
+    }
+    SimMsg *Slot = &Sim->Queue[Sim->QTail % SIM_QUEUE];
+    *Slot = *Msg;
+    Slot->AtUs = AtUs;
+    Sim->QTail++;
+}
+
+bool SimMqttConnect()
+{
+    SimAdvance(SimJitter(Sim->RttUs));
+    if (!SimWifiConnected())
+    {
+        return false;
+    }
+    Sim->Stats.RoundTrips++;
+    Sim->Stats.MqttConnects++;
+    // clean session
+    Sim->Session = true;
+    Sim->SubCnt = 0;
+    Sim->QHead = Sim->QTail = 0;
+    return true;
+}
+
+void SimMqttDisconnect()
+{
+    Sim->Session = false;
+    Sim->SubCnt = 0;
+    Sim->QHead = Sim->QTail = 0;
+}
+
+// SUBACK after one round trip, retained messages follow right away
+bool SimMqttSubscribe(const char *Filter)
+{
+    if (!Sim->Session || Sim->SubCnt >= SIM_SUBS || strlen(Filter) >= SIM_TOPIC_LEN)
+    {
+        return false;
+    }
+    SimAdvance(SimJitter(Sim->RttUs));
+    if (!Sim->Session)
+    {
+        return false;
+    }
+    Sim->Stats.RoundTrips++;
+    strcpy(Sim->Subs[Sim->SubCnt++], Filter);
+    for (int i = 0; i < Sim->RetainedCnt; i++)
+    {
+        if (SimTopicMatch(Filter, Sim->Retained[i].Topic))
+        {
+            SimQueue(&Sim->Retained[i], Sim->NowUs);
+        }
+    }
+    return true;
+}
+
+bool SimMqttPoll(SimMsg *Msg)
+{
+    if (!Sim->Session || Sim->QHead == Sim->QTail)
+    {
+        return false;
+    }
+    SimMsg *Head = &Sim->Queue[Sim->QHead % SIM_QUEUE];
+    if (Head->AtUs > Sim->NowUs)
+    {
+        return false;
+    }
+    *Msg = *Head;
+    Msg->Payload[Msg->Len] = '\0';
+    Sim->QHead++;
+    Sim->Stats.MsgsRcvd++;
+    return true;
+}
+
+const char *SimBrokerRetained(const char *Topic)
+{
+    for (int i = 0; i < Sim->RetainedCnt; i++)
+    {
+        if (strcmp(Sim->Retained[i].Topic, Topic) == 0)
+        {
+            return Sim->Retained[i].Payload;
+        }
+    }
+    return NULL;
+}
+
+void SimBrokerPublish(const char *Topic, const char *Payload, size_t Len, bool Retained, bool FromDevice)
+{
+    SimMsg Msg;
+    if (strlen(Topic) >= SIM_TOPIC_LEN)
+    {
+        return;
+    }
+    strcpy(Msg.Topic, Topic);
+    Msg.Len = (uint16_t)((Len < SIM_MSG_LEN) ? Len : SIM_MSG_LEN - 1);
+    memcpy(Msg.Payload, Payload, Msg.Len);
+    Msg.Payload[Msg.Len] = '\0';
+    Msg.AtUs = 0;
+
+    if (FromDevice)
+    {
+        Sim->Stats.MsgsSent++;
+        SimScenarioPublished(Msg.Topic, Msg.Payload);
+    }
+    if (Retained)
+    {
+        int i;
+        for (i = 0; i < Sim->RetainedCnt; i++)
+        {
+            if (strcmp(Sim->Retained[i].Topic, Topic) == 0)
+            {
+                break;
+            }
+        }
+        if (Msg.Len == 0)
+        {
+            // empty retained message clears the topic
+            if (i < Sim->RetainedCnt)
+            {
+                Sim->Retained[i] = Sim->Retained[--Sim->RetainedCnt];
+            }
+        }
+        else if (i < SIM_RETAINED)
+        {
+            Sim->Retained[i] = Msg;
+            if (i == Sim->RetainedCnt)
+            {
+                Sim->RetainedCnt++;
+            }
+        }
+    }
+    if (!Sim->Session)
+    {
+        return;
+    }
+    for (int i = 0; i < Sim->SubCnt; i++)
+    {
+        if (SimTopicMatch(Sim->Subs[i], Topic))
+        {
+            // feeder publishes travel half the round trip, device publishes come back from the broker
+            SimQueue(&Msg, Sim->NowUs + SimJitter(FromDevice ? Sim->RttUs : Sim->RttUs / 2));
+            break;
+        }
+    }
+}
@@ -0,0 +1,158 @@
+/*
+ * ESP32 Rememberall
+ * Host simulator: GPIO, serial console, LED ring, ePaper, button and NVS
+ */
+#include <Arduino.h>
+#include <FastLED.h>
+#include "hardware-config.h"
+#include "sim-host.h"
+
+CFastLED FastLED;
+
+static uint8_t SimPins[64];
+static bool SimLineStart = true;
+
+void SimPinWrite(int Pin, int Val)
+{
+    if (Pin < 0 || Pin >= (int)sizeof(SimPins))
+    {
+        return;
+    }
+    SimPins[Pin] = (uint8_t)Val;
+    if (Pin != EMB_PWS_U2)
+    {
+        return;
+    }
+    // supply switch of the LED ring
+    if (Val && !Sim->LedPower)
+    {
+        Sim->LedPower = true;
+        Sim->LedOnUs = Sim->NowUs;
+    }
+    else if (!Val && Sim->LedPower)
+    {
+        Sim->Stats.LedUs += Sim->NowUs - Sim->LedOnUs;
+        Sim->LedPower = false;
+    }
+}
+
+int SimPinRead(int Pin)
+{
+    if (Pin < 0 || Pin >= (int)sizeof(SimPins))
+    {
+        return LOW;
+    }
+    return SimPins[Pin];
+}
+
+// Console output of the firmware, every line prefixed with the true virtual time
+void SimSerialWrite(const uint8_t *Buf, size_t Len)
+{
+    if (!Sim->Verbose)
+    {
+        return;
+    }
+    for (size_t i = 0; i < Len; i++)
+    {
+        if (SimLineStart)
+        {
+            time_t Now = (time_t)(Sim->StartEpoch + (int64_t)(Sim->NowUs / 1000000ULL));
+            struct tm Tm;
+            localtime_r(&Now, &Tm);
+            fprintf(stdout, "[%02d.%02d. %02d:%02d:%02d.%03u] ", Tm.tm_mday, Tm.tm_mon + 1, Tm.tm_hour, Tm.tm_min, Tm.tm_sec,
+                    (unsigned)((Sim->NowUs / 1000ULL) % 1000ULL));
+            SimLineStart = false;
+        }
+        fputc(Buf[i], stdout);
+        if (Buf[i] == '\n')
+        {
+            SimLineStart = true;
+        }
+    }
+}
+
+void SimLedShow(int Leds)
+{
+    Sim->Stats.LedFrames++;
+    SimAdvance((uint64_t)Leds * SIM_LED_US_PER_PIXEL + 50);
+}
+
+// GxEPD2 waits for the BUSY line after each refresh
+void SimEpdRefresh(bool Partial)
+{
+    if (Partial)
+    {
+        Sim->Stats.PartialRefresh++;
+    }
+    else
+    {
+        Sim->Stats.FullRefresh++;
+    }
+    SimAdvance(SIM_EPD_REFRESH_MS * 1000ULL);
+}
+
+int SimButtonTake()
+{
+    if (Sim->BtnEvent == SIM_BTN_NONE || Sim->NowUs < Sim->BtnDueUs)
+    {
+        return SIM_BTN_NONE;
+    }
+    int Event = Sim->BtnEvent;
+    Sim->BtnEvent = SIM_BTN_NONE;
+    return Event;
+}
+
+SimNvsEntry *SimNvsFind(const char *Ns, const char *Key, bool Create)
+{
+    SimNvsEntry *Free = NULL;
+    for (int i = 0; i < SIM_NVS_ENTRIES; i++)
+    {
+        SimNvsEntry *Entry = &Sim->Nvs[i];
+        if (Entry->Ns[0] == '\0')
+        {
+            if (!Free)
+            {
+                Free = Entry;
+            }
+            continue;
+        }
+        if (strcmp(Entry->Ns, Ns) == 0 && strcmp(Entry->Key, Key) == 0)
+        {
+            return Entry;
+        }
+    }
+    if (!Create || !Free)
+    {
+        return NULL;
+    }
+    snprintf(Free->Ns, sizeof(Free->Ns), "%s", Ns);
+    snprintf(Free->Key, sizeof(Free->Key), "%s", Key);
+    Free->Len = 0;
+    return Free;
+}
+
+//
+// FastLED helpers
+//
+void fill_solid(CRGB *Leds, int Num, const CRGB &Color)
+{
+    for (int i = 0; i < Num; i++)
+    {
+        Leds[i] = Color;
+    }
+}
+
+void fadeToBlackBy(CRGB *Leds, uint16_t Num, uint8_t FadeBy)
+{
+    for (uint16_t i = 0; i < Num; i++)
+    {
+        Leds[i].nscale8(255 - FadeBy);
+    }
+}
+
+uint16_t beatsin16(uint16_t Bpm, uint16_t Low, uint16_t High)
+{
+    float Phase = (float)(millis() % 60000UL) * Bpm / 60000.0f;
+    float Sin = sinf(Phase * 2.0f * (float)M_PI);
+    return (uint16_t)(Low + (Sin + 1.0f) / 2.0f * (High - Low));
+}
@@ -0,0 +1,382 @@
+/*
+ * ESP32 Rememberall
+ * Host simulator: calendar, feeder (PowerShell-Feeder/Feed-Rememberall.ps1) and user
+ */
+#include <sys/mman.h>
+#include "setup.h"
+#include "payload-codec.h"
+#include "sim-host.h"
+
+#if defined(WAKE_STUB) || defined(ULP_MONITOR) || defined(OTA_PULL) || defined(FLEET_MODE)
+#error "WAKE_STUB, ULP_MONITOR, OTA_PULL and FLEET_MODE are not supported by the host simulator"
+#endif
+
+// Feeder configuration, same as $Config in Feed-Rememberall.ps1
+#define FEED_INTERVAL_S 3600 // scheduled task, every full hour (see README)
+#define FEED_COSY_H 24
+#define FEED_AGGRO_H 12
+#define FEED_PREVIEW_H 24
+#define FEED_MAX_LINES 3
+#define FEED_CHARS 10
+#define FEED_CHARS_ICON 8
+static const int FeedActiveStart[] = {5, 18};
+static const int FeedActiveEnd[] = {7, 20};
+
+// Local times (minutes of the day) the user passes by the Rememberall
+static const int UserChecks[] = {6 * 60 + 30, 7 * 60 + 40, 18 * 60 + 15, 19 * 60 + 30, 20 * 60 + 45};
+
+// Event categories as in $EventFilter
+struct SimEventKind
+{
+    const char *Summary;
+    uint8_t Icon;
+    uint32_t LedColor;
+    const char *Suffix; // suffix line (TXTSuffix), printed in black
+    bool AllDay;
+};
+static const SimEventKind EventKinds[] = {
+    {"Restmuell", 1, 0x0000FF, "raus!", true},
+    {"Physio Termin", 4, 0xFF0000, "", false},
+    {"Badminton Halle", 2, 0x00FF00, "", false},
+    {"Geburtstag Anna", 3, 0xFF7A01, "", true},
+    {"Elternabend Schule", 0, 0xFF00FF, "", false},
+};
+#define KIND_CNT (int)(sizeof(EventKinds) / sizeof(EventKinds[0]))
+
+struct SimCalEvent
+{
+    int64_t Start; // DTStart (local midnight for all-day events)
+    int Kind;
+};
+
+#define SIM_CAL_SIZE 256
+struct SimScenario
+{
+    uint32_t Rng;
+    int SnoozePercent;
+    uint64_t NextFeedUs;
+    uint64_t NextCheckUs;
+    int EventCnt;
+    SimCalEvent Events[SIM_CAL_SIZE];
+};
+// Shared with the firmware processes like SimState
+static SimScenario *Scn = NULL;
+
+static uint32_t ScnRand()
+{
+    // xorshift32
+    Scn->Rng ^= Scn->Rng << 13;
+    Scn->Rng ^= Scn->Rng >> 17;
+    Scn->Rng ^= Scn->Rng << 5;
+    return Scn->Rng;
+}
+
+static int64_t ScnNow()
+{
+    return Sim->StartEpoch + (int64_t)(Sim->NowUs / 1000000ULL);
+}
+
+// Epoch of the given local time, Days after the date of Epoch
+static int64_t ScnLocal(int64_t Epoch, int Days, int Hour, int Min)
+{
+    time_t T = (time_t)Epoch;
+    struct tm Tm;
+    localtime_r(&T, &Tm);
+    Tm.tm_mday += Days;
+    Tm.tm_hour = Hour;
+    Tm.tm_min = Min;
+    Tm.tm_sec = 0;
+    Tm.tm_isdst = -1;
+    return (int64_t)mktime(&Tm);
+}
+
+static uint32_t ScnFnv1a(const char *Str)
+{
+    uint32_t Hash = 2166136261UL;
+    while (*Str)
+    {
+        Hash = (Hash ^ (uint8_t)*Str++) * 16777619UL;
+    }
+    return Hash;
+}
+
+// Calculate-SleepUntil
+static void ScnSleepUntil(char *Buf, size_t Size, int64_t Now, bool Active)
+{
+    time_t T = (time_t)Now;
+    struct tm Tm;
+    localtime_r(&T, &Tm);
+    int Periods = (int)(sizeof(FeedActiveStart) / sizeof(FeedActiveStart[0]));
+    if (Active)
+    {
+        for (int i = 0; i < Periods; i++)
+        {
+            if (Tm.tm_hour >= FeedActiveStart[i] && Tm.tm_hour <= FeedActiveEnd[i])
+            {
+                snprintf(Buf, Size, "0");
+                return;
+            }
+        }
+    }
+    for (int i = 0; i < Periods; i++)
+    {
+        int64_t Start = ScnLocal(Now, 0, FeedActiveStart[i], 0);
+        if (Start >= Now)
+        {
+            snprintf(Buf, Size, "%lx", (unsigned long)Start);
+            return;
+        }
+    }
+    snprintf(Buf, Size, "%lx", (unsigned long)ScnLocal(Now, 1, FeedActiveStart[0], 0));
+}
+
+// Test-JournalAck
+static bool ScnJournalAck(const char *Journal, int64_t Deadline)
+{
+    while (Journal && *Journal)
+    {
+        unsigned long Seq, Epoch, Dl;
+        char Action;
+        if (sscanf(Journal, "%lx;%c;%lx;%lx", &Seq, &Action, &Epoch, &Dl) == 4 && Action == 'A' && (int64_t)Dl == Deadline)
+        {
+            return true;
+        }
+        Journal = strchr(Journal, '|');
+        if (Journal)
+        {
+            Journal++;
+        }
+    }
+    return false;
+}
+
+// Get-EventInfo
+static void ScnEventInfo(const SimCalEvent *Ev, char *Txt, size_t TxtSize, char *Reminder, size_t RemSize, int64_t *Deadline)
+{
+    const SimEventKind *Kind = &EventKinds[Ev->Kind];
+    int Chars = (Kind->Icon > 0) ? FEED_CHARS_ICON : FEED_CHARS;
+    int MaxLines = (Kind->Suffix[0] != '\0') ? FEED_MAX_LINES - 1 : FEED_MAX_LINES;
+    PayloadTxt Lines = {};
+    Lines.IconId = Kind->Icon;
+    // one word of the summary per line
+    const char *Word = Kind->Summary;
+    while (*Word && Lines.LineCnt < MaxLines)
+    {
+        size_t WordLen = strcspn(Word, " ");
+        Lines.LineCol[Lines.LineCnt] = 1;
+        Lines.Text[Lines.LineCnt] = Word;
+        Lines.TextLen[Lines.LineCnt] = (uint8_t)min(WordLen, (size_t)Chars);
+        Lines.LineCnt++;
+        Word += WordLen;
+        while (*Word == ' ')
+        {
+            Word++;
+        }
+    }
+    if (Kind->Suffix[0] != '\0')
+    {
+        Lines.LineCol[Lines.LineCnt] = 0;
+        Lines.Text[Lines.LineCnt] = Kind->Suffix;
+        Lines.TextLen[Lines.LineCnt] = (uint8_t)min(strlen(Kind->Suffix), (size_t)Chars);
+        Lines.LineCnt++;
+    }
+    PayloadEncodeTxt(&Lines, Txt, TxtSize);
+    *Deadline = Ev->Start + (Kind->AllDay ? 12 * 3600 : 0);
+    PayloadReminder Rem = {*Deadline, *Deadline - FEED_COSY_H * 3600, *Deadline - FEED_AGGRO_H * 3600, Kind->LedColor};
+    PayloadEncodeReminder(&Rem, Reminder, RemSize);
+}
+
+static void ScnPublish(const char *Topic, const char *Payload)
+{
+    SimBrokerPublish(Topic, Payload, strlen(Payload), true, false);
+}
+
+// Publish sequence of the feeder for a new event (QoS 1, retained)
+void SimFeederPublishEvent(const char *Txt, const char *Reminder, const char *Status, int64_t Now)
+{
+    char Manifest[40];
+    snprintf(Manifest, sizeof(Manifest), "%lx;%lx;%lx", (unsigned long)Now, (unsigned long)ScnFnv1a(Txt), (unsigned long)ScnFnv1a(Reminder));
+    ScnPublish(eventTxt_topic, Txt);
+    ScnPublish(eventReminder_topic, Reminder);
+    ScnPublish(Status_topic, Status);
+    ScnPublish(TOPTREE "Manifest", Manifest);
+}
+
+// One run of the feeder script
+static void ScnFeed()
+{
+    int64_t Now = ScnNow();
+    Sim->Stats.FeederRuns++;
+
+    const SimCalEvent *Next = NULL;
+    for (int i = 0; i < Scn->EventCnt; i++)
+    {
+        const SimCalEvent *Ev = &Scn->Events[i];
+        if (Ev->Start > Now && Ev->Start < Now + (FEED_PREVIEW_H + FEED_COSY_H) * 3600 && (!Next || Ev->Start < Next->Start))
+        {
+            Next = Ev;
+        }
+    }
+    char SleepUntil[20];
+    if (!Next)
+    {
+        snprintf(SleepUntil, sizeof(SleepUntil), "%lx", (unsigned long)(Now + FEED_PREVIEW_H * 3600));
+    }
+    else if (Next->Start < Now + FEED_COSY_H * 3600)
+    {
+        char Txt[160], Reminder[80];
+        int64_t Deadline;
+        bool Active = true;
+        ScnEventInfo(Next, Txt, sizeof(Txt), Reminder, sizeof(Reminder), &Deadline);
+        const char *OldTxt = SimBrokerRetained(eventTxt_topic);
+        if (!OldTxt || strcmp(OldTxt, Txt) != 0)
+        {
+            SimFeederPublishEvent(Txt, Reminder, "newEvent", Now);
+            Sim->Stats.NewEvents++;
+        }
+        else
+        {
+            const char *Status = SimBrokerRetained(Status_topic);
+            Active = !((Status && strcmp(Status, "ack") == 0) || ScnJournalAck(SimBrokerRetained(Journal_topic), Deadline));
+        }
+        ScnSleepUntil(SleepUntil, sizeof(SleepUntil), Now, Active);
+    }
+    else
+    {
+        ScnSleepUntil(SleepUntil, sizeof(SleepUntil), Now, false);
+    }
+    ScnPublish(sleep_until_topic, SleepUntil);
+}
+
+// The user presses the button if the LED ring is lit
+static void ScnUserCheck()
+{
+    if (!Sim->LedPower || Sim->BtnEvent != SIM_BTN_NONE)
+    {
+        return;
+    }
+    if ((int)(ScnRand() % 100) < Scn->SnoozePercent)
+    {
+        Sim->BtnEvent = SIM_BTN_CLICK;
+        Sim->Stats.Clicks++;
+    }
+    else
+    {
+        Sim->BtnEvent = SIM_BTN_DOUBLE;
+        Sim->Stats.Acks++;
+        if (Sim->AckClickUs == 0)
+        {
+            Sim->AckClickUs = Sim->NowUs;
+        }
+    }
+    Sim->BtnDueUs = Sim->NowUs + SIM_BTN_CLICK_MS * 1000ULL;
+}
+
+static uint64_t ScnNextCheckUs()
+{
+    int64_t Now = ScnNow();
+    for (int Day = 0; Day < 2; Day++)
+    {
+        for (size_t i = 0; i < sizeof(UserChecks) / sizeof(UserChecks[0]); i++)
+        {
+            int64_t Check = ScnLocal(Now, Day, UserChecks[i] / 60, UserChecks[i] % 60);
+            if (Check > Now)
+            {
+                return (uint64_t)(Check - Sim->StartEpoch) * 1000000ULL;
+            }
+        }
+    }
+    return UINT64_MAX;
+}
+
+void SimScenarioPublished(const char *Topic, const char *Payload)
+{
+    if (Sim->Bench)
+    {
+        return;
+    }
+    if (Sim->AckClickUs == 0 || strcmp(Topic, Status_topic) != 0 || strcmp(Payload, "ack") != 0)
+    {
+        return;
+    }
+    Sim->Stats.AckLatMs[Sim->Stats.AcksPublished % SIM_ACK_HIST] = (uint32_t)((Sim->NowUs - Sim->AckClickUs) / 1000ULL);
+    Sim->Stats.AcksPublished++;
+    Sim->AckClickUs = 0;
+}
+
+// Retained topics the firmware waits for besides the event topics (WAIT_FOR_SUBSCRIPTIONS)
+void SimBrokerSeed()
+{
+    ScnPublish(ota_topic, "off");
+    ScnPublish(otaInProgress_topic, "off");
+}
+
+void SimScenarioInit(uint32_t Seed, int SnoozePercent)
+{
+    Scn = (SimScenario *)mmap(NULL, sizeof(SimScenario), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (Scn == MAP_FAILED)
+    {
+        perror("mmap");
+        exit(1);
+    }
+    memset(Scn, 0, sizeof(SimScenario));
+    Scn->Rng = Seed ? Seed : 1;
+    Scn->SnoozePercent = SnoozePercent;
+    setenv("TZ", TIMEZONE, 1);
+    tzset();
+
+    // Calendar: one event every 18 to 54 hours, never the same category twice in a row
+    int64_t End = Sim->StartEpoch + (int64_t)(Sim->EndUs / 1000000ULL) + (FEED_PREVIEW_H + FEED_COSY_H) * 3600;
+    int64_t T = Sim->StartEpoch;
+    int Kind = -1;
+    while (Scn->EventCnt < SIM_CAL_SIZE)
+    {
+        T += (18 + ScnRand() % 37) * 3600;
+        if (T > End)
+        {
+            break;
+        }
+        Kind = (Kind + 1 + ScnRand() % (KIND_CNT - 1)) % KIND_CNT;
+        SimCalEvent *Ev = &Scn->Events[Scn->EventCnt++];
+        Ev->Kind = Kind;
+        Ev->Start = EventKinds[Kind].AllDay ? ScnLocal(T, 0, 0, 0) : ScnLocal(T, 0, 8 + ScnRand() % 12, (ScnRand() % 4) * 15);
+    }
+
+    // Retained topics left by the previous (acknowledged) event and the OTA handling
+    SimCalEvent Prev = {Sim->StartEpoch - 6 * 3600, 1};
+    char Txt[160], Reminder[80];
+    int64_t Deadline;
+    ScnEventInfo(&Prev, Txt, sizeof(Txt), Reminder, sizeof(Reminder), &Deadline);
+    SimFeederPublishEvent(Txt, Reminder, "ack", Sim->StartEpoch - 30 * 3600);
+    SimBrokerSeed();
+    Scn->NextFeedUs = 0;
+    Scn->NextCheckUs = ScnNextCheckUs();
+}
+
+uint64_t SimScenarioNextUs()
+{
+    if (Sim->Bench)
+    {
+        return SimBenchNextUs();
+    }
+    return min(Scn->NextFeedUs, Scn->NextCheckUs);
+}
+
+void SimScenarioRun()
+{
+    if (Sim->Bench)
+    {
+        SimBenchRun();
+        return;
+    }
+    while (Scn->NextFeedUs <= Sim->NowUs)
+    {
+        ScnFeed();
+        Scn->NextFeedUs += FEED_INTERVAL_S * 1000000ULL;
+    }
+    if (Scn->NextCheckUs <= Sim->NowUs)
+    {
+        ScnUserCheck();
+        Scn->NextCheckUs = ScnNextCheckUs();
+    }
+}
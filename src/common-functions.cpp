@@ -3,6 +3,7 @@
  * Common Functions
  */
 #include "setup.h"
+#include "driver/rtc_io.h"
 
 // Function to toggle a LED (GPIO pin)
 void ToggleLed(int PIN, int WaitTime, int Count)
@@ -15,6 +16,37 @@ void ToggleLed(int PIN, int WaitTime, int Count)
     }
 }
 
+// Enter DeepSleep for the given amount of seconds (RTC drift compensated); pass the (active low) wakeup button or -1
+// Closes energy accounting and arms wake stub / ULP monitor, so every DeepSleep should be entered here
+void EnterDeepSleep(uint32_t Seconds, int ButtonGpio)
+{
+#ifdef RTC_DRIFT_LEARNING
+    uint64_t SleepUs = DriftPrepareSleep(Seconds);
+#else
+    uint64_t SleepUs = (uint64_t)Seconds * 1000000ULL;
+#endif
+    esp_sleep_enable_timer_wakeup(SleepUs);
+    if (ButtonGpio >= 0)
+    {
+        // Arm button as wakeup source (active low); RTC peripherals need to stay powered for the internal pullup
+        esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_PERIPH, ESP_PD_OPTION_ON);
+        rtc_gpio_pullup_en((gpio_num_t)ButtonGpio);
+        rtc_gpio_pulldown_dis((gpio_num_t)ButtonGpio);
+        esp_sleep_enable_ext0_wakeup((gpio_num_t)ButtonGpio, 0);
+    }
+    LogFlush();
+#ifdef ENERGY_STATS
+    EnergySleep(SleepUs);
+#endif
+#ifdef WAKE_STUB
+    WakeStubArm(SleepUs, ButtonGpio);
+#endif
+#ifdef ULP_MONITOR
+    UlpMonitorArm();
+#endif
+    esp_deep_sleep_start();
+}
+
 // Function to connect to MQTT Broker and subscribe to Topics
 bool MqttConnectToBroker()
 {
@@ -23,17 +55,36 @@ bool MqttConnectToBroker()
     // Try to connect x times, then return error
     while (ConnAttempt < MAXCONNATTEMPTS)
     {
-        DEBUG_PRINT("Connecting to MQTT broker..");
         if (mqttClt.connect(MQTT_CLTNAME))
         {
-            DEBUG_PRINTLN("connected");
+            LOG_I("Connected to MQTT broker");
             // Reset subscribed/received Topics counters
             int SubscribedTopics = 0;
             for (int i = 0; i < SubscribedTopicCnt; i++)
             {
                 MqttSubscriptions[i].Subscribed = false;
                 MqttSubscriptions[i].MsgRcvd = 0;
+                if (MqttSubscriptions[i].Deferred)
+                {
+                    // will be subscribed on demand (see MqttSubscribe)
+                    SubscribedTopics++;
+                }
+            }
+#ifdef MQTT_SUB_WILDCARD
+            // Subscribe to the whole topic tree at once, messages are dispatched in MqttCallback
+            // topics outside of TOPTREE (or all topics if this fails) are subscribed one by one below
+            if (mqttClt.subscribe(TOPTREE "#", SUB_QOS))
+            {
+                for (int i = 0; i < SubscribedTopicCnt; i++)
+                {
+                    if (!MqttSubscriptions[i].Deferred && strncmp(MqttSubscriptions[i].Topic, TOPTREE, sizeof(TOPTREE) - 1) == 0)
+                    {
+                        MqttSubscriptions[i].Subscribed = true;
+                        SubscribedTopics++;
+                    }
+                }
             }
+#endif
             // Subscribe to all configured Topics
             while ((SubscribedTopics < SubscribedTopicCnt) && mqttClt.connected())
             {
@@ -42,10 +93,10 @@ bool MqttConnectToBroker()
                     // Make sure broker is still connected to avoid looping endlessly
                     if (!mqttClt.connected())
                     {
-                        DEBUG_PRINTLN("Lost connection while subscribing to topics, reconnecting!");
+                        LOG_W("Lost connection while subscribing to topics, reconnecting!");
                         break;
                     }
-                    if (!MqttSubscriptions[i].Subscribed)
+                    if (!MqttSubscriptions[i].Subscribed && !MqttSubscriptions[i].Deferred)
                     {
                         if (mqttClt.subscribe(MqttSubscriptions[i].Topic,SUB_QOS))
                         {
@@ -66,15 +117,15 @@ bool MqttConnectToBroker()
             }
             else
             {
-                DEBUG_PRINTLN("Something went wrong, restarting..");
+                LOG_E("Something went wrong, restarting..");
                 delay(1000);
                 ConnAttempt++;
             }
         }
         else
         {
-            DEBUG_PRINTLN("failed, rc=" + String(mqttClt.state()));
-            DEBUG_PRINTLN("Sleeping 2 seconds..");
+            LOG_W("Connecting to MQTT broker failed, rc=%d, sleeping 2 seconds..", mqttClt.state());
+            DIAG_ADD(DIAG_NET, DIAG_NET_MQTT, mqttClt.state());
             delay(2000);
             ConnAttempt++;
         }
@@ -82,11 +133,46 @@ bool MqttConnectToBroker()
     return RetVal;
 }
 
+// Function to subscribe to a deferred topic (see MqttSubCfg); it will also be subscribed on reconnects from now on
+bool MqttSubscribe(const char *Topic)
+{
+    for (int i = 0; i < SubscribedTopicCnt; i++)
+    {
+        if (strcmp(MqttSubscriptions[i].Topic, Topic) == 0)
+        {
+            MqttSubscriptions[i].Deferred = false;
+            if (!MqttSubscriptions[i].Subscribed && mqttClt.connected() && mqttClt.subscribe(Topic, SUB_QOS))
+            {
+                MqttSubscriptions[i].Subscribed = true;
+            }
+            return MqttSubscriptions[i].Subscribed;
+        }
+    }
+    return false;
+}
+
+// Returns true if no message has been received yet for a subscribed topic (deferred topics are ignored, optional ones
+// only if WithOptional is set)
+bool MqttTopicsMissing(bool WithOptional)
+{
+    for (int i = 0; i < SubscribedTopicCnt; i++)
+    {
+        if (MqttSubscriptions[i].MsgRcvd == 0 && !MqttSubscriptions[i].Deferred && (WithOptional || !MqttSubscriptions[i].Optional))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 // Function to handle MQTT stuff (broker connections, subscriptions, updates), called in main loop
 void MqttUpdater()
 {
     if (!mqttClt.connected())
     {
+#ifdef DIAG_RING
+        unsigned long MqttStartMillis = millis();
+#endif
         if (MqttConnectToBroker())
         {
             // New connection to broker, fetch topics
@@ -94,27 +180,18 @@ void MqttUpdater()
             NetState = NET_UP;
             #ifdef WAIT_FOR_SUBSCRIPTIONS
             // ATTN: only try for MAX_TOP_RCV_ATTEMPTS then end according to NETFAILACTION
-            DEBUG_PRINT("Waiting for messages from subscribed topics..");
+            LOG_I("Waiting for messages from subscribed topics..");
             int TopicRcvAttempts = 0;
             bool MissingTopics = true;
             while (TopicRcvAttempts < MAX_TOP_RCV_ATTEMPTS)
             {
-                MissingTopics = false;
-                for (int i = 0; i < SubscribedTopicCnt; i++)
-                {
-                    if (MqttSubscriptions[i].MsgRcvd == 0)
-                    {
-                        MissingTopics = true;
-                        break;
-                    }
-                }
+                MissingTopics = MqttTopicsMissing(false);
                 if (MissingTopics)
                 {
-                    DEBUG_PRINT(".:T!:.");
                     TopicRcvAttempts++;
                     if (!mqttClt.loop())
                     {
-                        DEBUG_PRINTLN("  Lost connection to broker while waiting for topics, reconnecting.");
+                        LOG_W("Lost connection to broker while waiting for topics, reconnecting.");
                         MqttConnectToBroker();
                     }
 #ifdef ONBOARD_LED
@@ -125,8 +202,13 @@ void MqttUpdater()
                 }
                 else
                 {
-                    DEBUG_PRINTLN("");
-                    DEBUG_PRINTLN("Messages for all subscribed topics received.");
+                    LOG_I("Messages for all subscribed topics received.");
+                    // retained messages of optional topics may still be on their way
+                    for (int i = 0; i < OPT_TOP_RCV_ATTEMPTS && MqttTopicsMissing(true); i++)
+                    {
+                        mqttClt.loop();
+                        delay(100);
+                    }
                     break;
                 }
             }
@@ -135,38 +217,37 @@ void MqttUpdater()
                 if (NetFailAction == 0)
                 {
 #ifdef E32_DEEP_SLEEP
-                    esp_deep_sleep((uint64_t)DS_DURATION_MIN * 60000000);
+                    EnterDeepSleep(DS_DURATION_MIN * 60, -1);
 #else
                     ESP.restart();
 #endif
                 }
                 else
                 {
-                    DEBUG_PRINTLN("Unable fetch messages for all subscribed topics, continuing offline");
+                    LOG_W("Unable fetch messages for all subscribed topics, continuing offline");
                     NetState = NET_FAIL;
                 }
             }
 #endif // WAIT_FOR_SUBSCRIPTIONS
-            DEBUG_PRINTLN("");
-            DEBUG_PRINTLN("Messages for all subscribed topics received.");
+            DIAG_ADD(DIAG_PHASE, DIAG_PH_MQTT, millis() - MqttStartMillis);
         }
         else
         {
-            DEBUG_PRINTLN("Unable to connect to MQTT broker.");
+            LOG_E("Unable to connect to MQTT broker.");
 #ifdef ONBOARD_LED
             ToggleLed(LED, 100, 40);
 #endif
             if (NetFailAction == 0)
             {
 #ifdef E32_DEEP_SLEEP
-                esp_deep_sleep((uint64_t)DS_DURATION_MIN * 60000000);
+                EnterDeepSleep(DS_DURATION_MIN * 60, -1);
 #else
                 ESP.restart();
 #endif
             }
             else
             {
-                DEBUG_PRINTLN("Unable to connect to Broker, continuing offline");
+                LOG_W("Unable to connect to Broker, continuing offline");
                 NetState = NET_FAIL;
             }
         }
@@ -200,29 +281,32 @@ void MqttDelay(uint32_t delayms)
     }
 }
 
+// Connections which waited for an upload in vain (kept during DeepSleep, see OTA_PUSH_MAX_ATTEMPTS)
+RTC_DATA_ATTR uint8_t OtaPushTimeouts = 0;
+
 // Function to handle OTA flashing (called in main loop)
 // Returns TRUE while OTA-update was requested or in progress
 bool OTAUpdateHandler()
 {
     // If OTA Firmware Update is requested,
     // only loop through OTA function until finished (or reset by MQTT)
+    static unsigned long OtaRequestMillis = 0;
     if (OTAupdate)
     {
-        DEBUG_PRINT("OTAupdate in progress, need to wait for all MQTT topics..");
+        LOG_I("OTAupdate in progress, need to wait for all MQTT topics..");
         bool MissingTopics = true;
+        unsigned long TopicWaitStart = millis();
         while (MissingTopics)
         {
-            MissingTopics = false;
-            for (int i = 0; i < SubscribedTopicCnt; i++)
+            if (millis() - TopicWaitStart > OTA_TOPIC_TIMEOUT)
             {
-                if (MqttSubscriptions[i].MsgRcvd == 0)
-                {
-                    MissingTopics = true;
-                }
+                LOG_W("OTA: timeout waiting for MQTT topics, ignoring request until next connection");
+                OTAupdate = false;
+                return false;
             }
+            MissingTopics = MqttTopicsMissing(false);
             if (MissingTopics)
             {
-                DEBUG_PRINT(".:OTA_T!:.");
                 mqttClt.loop();
 #ifdef ONBOARD_LED
                 ToggleLed(LED, 50, 2);
@@ -234,7 +318,7 @@ bool OTAUpdateHandler()
         // got all topics, continue
         if (OtaInProgress && !OtaIPsetBySketch)
         {
-            DEBUG_PRINTLN("OTA firmware update successful, resuming normal operation..");
+            LOG_I("OTA firmware update successful, resuming normal operation..");
             // Make sure that MQTT Broker is connected
             MqttUpdater();
             mqttClt.publish(otaStatus_topic, String(UPDATEOK).c_str(), true);
@@ -245,6 +329,7 @@ bool OTAUpdateHandler()
             OtaIPsetBySketch = true;
             SentOtaIPtrue = false;
             SentUpdateRequested = false;
+            OtaPushTimeouts = 0;
             delay(200);
             return false;
         }
@@ -252,8 +337,30 @@ bool OTAUpdateHandler()
         {
             mqttClt.publish(otaStatus_topic, String(UPDATEREQ).c_str(), true);
             SentUpdateRequested = true;
+            OtaRequestMillis = millis();
         }
-        DEBUG_PRINTLN("OTA firmware update requested, waiting for upload..");
+        else if (millis() - OtaRequestMillis > OTA_PUSH_TIMEOUT)
+        {
+            // Nobody pushed an image in time, resume normal operation (retained OTAupdate flag will retry at next connection)
+            LOG_W("OTA: no upload within %d seconds, resuming normal operation", OTA_PUSH_TIMEOUT / 1000);
+            mqttClt.publish(otaStatus_topic, UPDATETIMEOUT, true);
+            mqttClt.publish(otaInProgress_topic, "off", true);
+            if (++OtaPushTimeouts >= OTA_PUSH_MAX_ATTEMPTS)
+            {
+                // don't keep every connection awake for another OTA_PUSH_TIMEOUT
+                LOG_W("OTA: giving up after %d attempts, resetting update request", OTA_PUSH_MAX_ATTEMPTS);
+                mqttClt.publish(ota_topic, "off", true);
+                OtaPushTimeouts = 0;
+            }
+            OTAupdate = false;
+            OtaInProgress = false;
+            OtaIPsetBySketch = false;
+            SentOtaIPtrue = false;
+            SentUpdateRequested = false;
+            delay(200);
+            return false;
+        }
+        LOG_I("OTA firmware update requested, waiting for upload..");
 #ifdef ONBOARD_LED
         // Signal OTA update requested
         ToggleLed(LED, 100, 5);
@@ -261,7 +368,7 @@ bool OTAUpdateHandler()
         // set MQTT reminder that OTA update was executed
         if (!SentOtaIPtrue)
         {
-            DEBUG_PRINTLN("Setting MQTT OTA-update reminder flag on broker..");
+            LOG_I("Setting MQTT OTA-update reminder flag on broker..");
             mqttClt.publish(otaInProgress_topic, String("on").c_str(), true);
             OtaInProgress = true;
             SentOtaIPtrue = true;
@@ -276,13 +383,14 @@ bool OTAUpdateHandler()
     {
         if (SentUpdateRequested)
         {
-            DEBUG_PRINTLN("OTA firmware update cancelled by user, cleaning up and rebooting..");
+            LOG_I("OTA firmware update cancelled by user, cleaning up and rebooting..");
             // Make sure that MQTT Broker is connected
             MqttUpdater();
             mqttClt.publish(otaStatus_topic, String(UPDATECANC).c_str(), true);
             mqttClt.publish(otaInProgress_topic, String("off").c_str(), true);
             delay(200);
             // Reboot after cancelled update
+            LogFlush();
             ESP.restart();
             delay(500);
             return false;
@@ -307,9 +415,60 @@ void wifi_up()
     }
 }
 
+#ifdef CONNECTED_IDLE
+// millis() when connected idle has been entered, 0 if not idle
+static unsigned long IdleStartMillis = 0;
+// CPU frequency to restore when leaving connected idle
+static uint32_t IdleCpuMhz = 0;
+bool ConnectedIdleBusy = false;
+
+// Set CPU frequency and automatic light sleep
+void ConnectedIdlePower(uint32_t CpuMhz, bool LightSleep)
+{
+#if CONFIG_PM_ENABLE && CONFIG_FREERTOS_USE_TICKLESS_IDLE && ESP_IDF_VERSION_MAJOR >= 5
+    esp_pm_config_t PmCfg = {.max_freq_mhz = (int)CpuMhz, .min_freq_mhz = LightSleep ? 40 : (int)CpuMhz, .light_sleep_enable = LightSleep};
+    esp_pm_configure(&PmCfg);
+#endif
+    setCpuFrequencyMhz(CpuMhz);
+}
+
+// Keep WiFi and MQTT connection up after all data has been handled; messages will be pushed by the broker
+void ConnectedIdleEnter()
+{
+    if (IdleStartMillis == 0)
+    {
+        IdleStartMillis = millis() | 1;
+        LOG_I("Connected idle: listen interval %d beacons, MQTT keepalive %ds", WIFI_LISTEN_INTERVAL, CI_MQTT_KEEPALIVE);
+        // Clock down (and enter light sleep between beacons if supported) only while idle
+        IdleCpuMhz = getCpuFrequencyMhz();
+        ConnectedIdlePower(CI_CPU_FREQ_MHZ, true);
+    }
+}
+
+// Returns true while in connected idle
+bool ConnectedIdle()
+{
+    return IdleStartMillis != 0;
+}
+#endif
+
 // Disconnect MQTT, stop services and disable WiFi
 void wifi_down()
 {
+    if (NetState != NET_DOWN)
+    {
+        DIAG_ADD(DIAG_PHASE, DIAG_PH_SESSION, millis() - WiFiStartMillis);
+    }
+#ifdef CONNECTED_IDLE
+    if (IdleStartMillis != 0)
+    {
+        uint32_t IdleSeconds = (millis() - IdleStartMillis) / 1000;
+        LOG_I("Connected idle ended after %lus", (unsigned long)IdleSeconds);
+        DIAG_ADD(DIAG_PHASE, DIAG_PH_IDLE, IdleSeconds);
+        IdleStartMillis = 0;
+        ConnectedIdlePower(IdleCpuMhz, false);
+    }
+#endif
     mqttClt.disconnect();
     ArduinoOTA.end();
 #ifdef NTP_CLT
@@ -330,64 +489,86 @@ void wifi_down()
 //
 void MqttCallback(char *topic, byte *payload, unsigned int length)
 {
+    // Find the subscription first: with MQTT_SUB_WILDCARD, the ESP also receives its own publishes (e.g. log_topic)
+    // these are dropped silently, logging them would publish them again with LOG_MQTT
+    MqttSubCfg *Sub = NULL;
+    for (int i = 0; i < SubscribedTopicCnt; i++)
+    {
+#ifdef FLEET_MODE
+        char FleetBuf[FLEET_TOPIC_SIZE];
+        if (strcmp(topic, FleetTopic(MqttSubscriptions[i].Topic, FleetBuf, sizeof(FleetBuf))) == 0)
+#else
+        if (strcmp(topic, MqttSubscriptions[i].Topic) == 0)
+#endif
+        {
+            Sub = &MqttSubscriptions[i];
+            break;
+        }
+    }
+    if (Sub == NULL)
+    {
+        return;
+    }
     unsigned int i = 0;
+    if (length >= sizeof(message_buff))
+    {
+        LOG_W("MQTT: Message for topic [%s] too long, truncated", topic);
+        length = sizeof(message_buff) - 1;
+    }
     // create character buffer with ending null terminator (string)
     for (i = 0; i < length; i++)
     {
         message_buff[i] = payload[i];
     }
     message_buff[i] = '\0';
-    String msgString = String(message_buff);
 
-    DEBUG_PRINTLN("MQTT: Message arrived [" + String(topic) + "]: " + String(msgString));
+    LOG_D("MQTT: Message arrived [%s]: %s", topic, message_buff);
 
-    // run through topics
-    for (int i = 0; i < SubscribedTopicCnt; i++)
+    // Handle message according to the subscription type
+    switch (Sub->Type)
     {
-        if (String(topic) == String(MqttSubscriptions[i].Topic))
+    case 0:
+        // Handle subscription Type BOOL
+        if (strcmp(message_buff, "on") == 0)
         {
-            // Topic found, handle message
-            switch (MqttSubscriptions[i].Type)
-            {
-            case 0:
-                // Handle subscription Type BOOL
-                if (msgString == "on")
-                {
-                    *MqttSubscriptions[i].BoolPtr = true;
-                    MqttSubscriptions[i].MsgRcvd++;
-                }
-                else if (msgString == "off")
-                {
-                    *MqttSubscriptions[i].BoolPtr = false;
-                    MqttSubscriptions[i].MsgRcvd++;
-                }
-                else
-                {
-                    DEBUG_PRINTLN("MQTT: ERROR: Fetched invalid BOOL for topic [" + String(topic) + "]: " + String(msgString));
-                }
-                break;
-            case 1:
-                // Handle subscription of type INTEGER
-                *MqttSubscriptions[i].IntPtr = (int)msgString.toInt();
-                MqttSubscriptions[i].MsgRcvd++;
-                break;
-            case 2:
-                // Handle subscriptions of type FLOAT
-                *MqttSubscriptions[i].FloatPtr = msgString.toFloat();
-                MqttSubscriptions[i].MsgRcvd++;
-                break;
-            case 3:
-                // Handle subscriptions of type time_t (message decoded as hex!)
-                *MqttSubscriptions[i].TimePtr = (time_t)strtol(msgString.c_str(), NULL, 16);
-                MqttSubscriptions[i].MsgRcvd++;
-                break;
-            case 4:
-                // Handle subscriptions of type string (copy from message_buff)
-                strcpy(MqttSubscriptions[i].stringPtr, message_buff);
-                MqttSubscriptions[i].MsgRcvd++;
-                break;
-            }
+            *Sub->BoolPtr = true;
+            Sub->MsgRcvd++;
+        }
+        else if (strcmp(message_buff, "off") == 0)
+        {
+            *Sub->BoolPtr = false;
+            Sub->MsgRcvd++;
+        }
+        else
+        {
+            LOG_E("MQTT: Fetched invalid BOOL for topic [%s]: %s", topic, message_buff);
         }
+        break;
+    case 1:
+        // Handle subscription of type INTEGER
+        *Sub->IntPtr = (int)strtol(message_buff, NULL, 10);
+        Sub->MsgRcvd++;
+        break;
+    case 2:
+        // Handle subscriptions of type FLOAT
+        *Sub->FloatPtr = strtof(message_buff, NULL);
+        Sub->MsgRcvd++;
+        break;
+    case 3:
+        // Handle subscriptions of type time_t (message decoded as hex!)
+        *Sub->TimePtr = (time_t)strtol(message_buff, NULL, 16);
+        Sub->MsgRcvd++;
+        break;
+    case 4:
+        // Handle subscriptions of type string (copy from message_buff)
+        strlcpy(Sub->stringPtr, message_buff, MQTT_MAX_MSG_SIZE);
+        Sub->MsgRcvd++;
+        break;
+    case 5:
+        // Handle subscriptions of type long string (copy from message_buff)
+        strlcpy(Sub->stringPtr, message_buff, MQTT_RCV_BUF_SIZE);
+        Sub->MsgRcvd++;
+        break;
     }
 }
 
@@ -397,5 +578,22 @@ void NTP_Synced_Callback(struct timeval *t)
 {
     // Update global time-synced flag
     NTPSyncCounter++;
+    TimeTrustSynced(t->tv_sec);
 }
 #endif // NTP_CLT
+
+#ifdef MEM_REPORT
+// Publish heap statistics to mem_topic
+// uses a fixed buffer to avoid influencing the heap we're reporting
+void PublishMemStats()
+{
+    uint32_t FreeHeap = ESP.getFreeHeap();
+    uint32_t MaxAlloc = ESP.getMaxAllocHeap();
+    uint32_t Frag = (FreeHeap > 0) ? (100 - (MaxAlloc * 100) / FreeHeap) : 0;
+    char MemMsg[64];
+    snprintf(MemMsg, sizeof(MemMsg), "%lu;%lu;%lu;%lu;%lu", (unsigned long)FreeHeap, (unsigned long)ESP.getMinFreeHeap(),
+             (unsigned long)MaxAlloc, (unsigned long)Frag, (unsigned long)uxTaskGetStackHighWaterMark(NULL));
+    mqttClt.publish(mem_topic, MemMsg, true);
+    LOG_D("MemStats: %s", MemMsg);
+}
+#endif // MEM_REPORT
@@ -0,0 +1,78 @@
+/*
+ * ESP32 Rememberall
+ * Countdown overlay schedule
+ */
+#include "countdown.h"
+#include "generic-config.h"
+
+#ifdef D_COUNTDOWN
+//
+// The countdown will only be refreshed within the active reminder period (CosyReminder until Deadline),
+// as the display is redrawn completely on every new event anyway.
+// Refreshes are spread evenly over the period with a minimum spacing of D_CD_MIN_INTERVAL minutes,
+// aligned backwards from the deadline so that every refresh shows an exact value.
+//
+void CountdownPlan(CountdownSchedule *Sched, eventInfoStruct *EventData, time_t Now)
+{
+    Sched->Cnt = 0;
+    Sched->Next = 0;
+    time_t PeriodStart = (EventData->CosyReminder > Now) ? EventData->CosyReminder : Now;
+    if (EventData->Deadline <= PeriodStart)
+    {
+        // Nothing to count down
+        return;
+    }
+    // Stretch refresh interval (in multiples of D_CD_MIN_INTERVAL) until the schedule fits into D_CD_MAX_UPDATES
+    time_t Period = EventData->Deadline - PeriodStart;
+    time_t Step = (time_t)D_CD_MIN_INTERVAL * 60;
+    while (Period / Step > D_CD_MAX_UPDATES)
+    {
+        Step += (time_t)D_CD_MIN_INTERVAL * 60;
+    }
+    int Cnt = Period / Step;
+    if (Period % Step == 0)
+    {
+        // first entry would be PeriodStart itself, which is covered by the full display refresh
+        Cnt--;
+    }
+    for (int i = 0; i < Cnt; i++)
+    {
+        Sched->UpdateAt[i] = EventData->Deadline - (time_t)(Cnt - i) * Step;
+    }
+    Sched->Cnt = Cnt;
+    LOG_D("Countdown: %d refreshes planned every %ld minutes", Cnt, (long)Step / 60);
+}
+
+bool CountdownDue(CountdownSchedule *Sched, time_t Now)
+{
+    bool Due = false;
+    while (Sched->Next < Sched->Cnt && Sched->UpdateAt[Sched->Next] <= Now)
+    {
+        Sched->Next++;
+        Due = true;
+    }
+    return Due;
+}
+
+void CountdownFormat(char *Buf, size_t BufLen, time_t Remaining)
+{
+    // Round to nearest unit; max. 3 characters fit into the left display column
+    if (Remaining < 90L * 60L)
+    {
+        snprintf(Buf, BufLen, "%ldm", (long)((Remaining + 30) / 60));
+    }
+    else if (Remaining < 90L * 3600L)
+    {
+        snprintf(Buf, BufLen, "%ldh", (long)((Remaining + 1800) / 3600));
+    }
+    else if (Remaining < 99L * 86400L + 43200L)
+    {
+        snprintf(Buf, BufLen, "%ldd", (long)((Remaining + 43200) / 86400));
+    }
+    else
+    {
+        // 100 days and more; "99d+" would not fit into the side column
+        snprintf(Buf, BufLen, "99+");
+    }
+}
+#endif // D_COUNTDOWN
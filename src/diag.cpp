@@ -0,0 +1,79 @@
+/*
+ * ESP32 Template
+ * Remote diagnostics
+ */
+#include "setup.h"
+#include "diag.h"
+
+#ifdef DIAG_RING
+struct DiagRingStruct
+{
+    uint32_t Magic;
+    uint16_t Next; // index of the next record to write
+    uint16_t Cnt;  // number of valid records
+    DiagRecord Records[DIAG_RING_SIZE];
+};
+// RTC_NOINIT: also keep records over panic / watchdog / brownout resets
+RTC_NOINIT_ATTR DiagRingStruct DiagRing;
+bool DiagRequest = false;
+
+void DiagAdd(uint8_t Type, uint8_t Code, int32_t Value)
+{
+    if (DiagRing.Magic != DIAG_MAGIC || DiagRing.Next >= DIAG_RING_SIZE || DiagRing.Cnt > DIAG_RING_SIZE)
+    {
+        // RTC memory lost (power loss) or corrupt
+        memset(&DiagRing, 0, sizeof(DiagRing));
+        DiagRing.Magic = DIAG_MAGIC;
+    }
+    DiagRecord *Rec = &DiagRing.Records[DiagRing.Next];
+    Rec->Epoch = (uint32_t)time(NULL);
+    Rec->Value = Value;
+    Rec->Type = Type;
+    Rec->Code = Code;
+    DiagRing.Next = (DiagRing.Next + 1) % DIAG_RING_SIZE;
+    if (DiagRing.Cnt < DIAG_RING_SIZE)
+    {
+        DiagRing.Cnt++;
+    }
+}
+
+// Format record i (0 = oldest) to Buf, returns length
+int DiagFormat(char *Buf, size_t BufLen, int i)
+{
+    DiagRecord *Rec = &DiagRing.Records[(DiagRing.Next + DIAG_RING_SIZE - DiagRing.Cnt + i) % DIAG_RING_SIZE];
+    return snprintf(Buf, BufLen, "%s%c;%u;%ld;%lx", (i > 0) ? "|" : "", Rec->Type, Rec->Code, (long)Rec->Value, (unsigned long)Rec->Epoch);
+}
+
+void DiagHandle()
+{
+    if (!DiagRequest)
+    {
+        return;
+    }
+    if (DiagRing.Magic != DIAG_MAGIC)
+    {
+        DiagRing.Cnt = 0;
+    }
+    // Message may exceed the PubSubClient buffer, so stream it record by record
+    char Buf[40];
+    unsigned int Len = 0;
+    for (int i = 0; i < DiagRing.Cnt; i++)
+    {
+        Len += DiagFormat(Buf, sizeof(Buf), i);
+    }
+    if (!mqttClt.beginPublish(diag_topic, Len, true))
+    {
+        return;
+    }
+    for (int i = 0; i < DiagRing.Cnt; i++)
+    {
+        int RecLen = DiagFormat(Buf, sizeof(Buf), i);
+        mqttClt.write((const uint8_t *)Buf, RecLen);
+    }
+    if (mqttClt.endPublish() && mqttClt.publish(diag_req_topic, "off", true))
+    {
+        DiagRequest = false;
+        LOG_I("Diag: published %d records", DiagRing.Cnt);
+    }
+}
+#endif // DIAG_RING
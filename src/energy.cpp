@@ -0,0 +1,207 @@
+/*
+ * ESP32 Rememberall
+ * Energy accounting
+ */
+#include "setup.h"
+#include "energy.h"
+
+#ifdef ENERGY_STATS
+#define EN_MAGIC 0x454E5232 // marks initialized statistics in RTC memory (change with the EnergyRecord layout)
+
+static const float EnergyCoeff[EN_CNT] = {EN_MA_ACTIVE, EN_MA_ASSOC, EN_MA_SESSION, EN_MA_IDLE, EN_MA_SLEEP, EN_MA_EPAPER, EN_MA_LED};
+
+// Consumption of a finished day
+struct EnergyDay
+{
+    uint32_t Day;            // epoch / 86400
+    float Mah[EN_CNT];       // consumption per state
+};
+
+// Statistics kept during DeepSleep
+struct EnergyRecord
+{
+    uint32_t Magic;          // EN_MAGIC
+    uint32_t Day;            // current day (epoch / 86400), 0 if unknown
+    uint32_t Ms[EN_CNT];     // durations of the current day
+    EnergyDay Pending[EN_PENDING_DAYS]; // finished days not published yet, oldest first
+    uint32_t PendingCnt;     // valid entries in Pending
+    float TotalMah;          // consumption of all finished days since power loss
+    uint64_t SleepUs;        // planned DeepSleep duration
+    time_t SleepStart;       // epoch when entering DeepSleep (0 = unknown)
+};
+RTC_DATA_ATTR EnergyRecord EnergyStats;
+
+static unsigned long EnergyLastMillis = 0;     // last call of EnergyHandle
+static uint32_t EnergyAccounted = 0;           // ms already accounted by EnergyAdd since the last EnergyHandle
+static unsigned long EnergyOnMillis[EN_CNT];   // millis() when the consumer has been switched on (0 = off)
+
+static float EnergyMah(int State, uint32_t Ms)
+{
+    return EnergyCoeff[State] * (float)Ms / 3600000.0f;
+}
+
+// Finish the current day (queue it for publishing) and continue with NewDay
+static void EnergyRollover(uint32_t NewDay)
+{
+    if (EnergyStats.PendingCnt >= EN_PENDING_DAYS)
+    {
+        // offline for too long, drop the oldest day (still included in TotalMah)
+        LOG_W("Energy: dropping unpublished day %lx", (unsigned long)EnergyStats.Pending[0].Day * 86400UL);
+        memmove(&EnergyStats.Pending[0], &EnergyStats.Pending[1], sizeof(EnergyDay) * (EN_PENDING_DAYS - 1));
+        EnergyStats.PendingCnt = EN_PENDING_DAYS - 1;
+    }
+    EnergyDay *Finished = &EnergyStats.Pending[EnergyStats.PendingCnt++];
+    Finished->Day = EnergyStats.Day;
+    float DayMah = 0;
+    for (int i = 0; i < EN_CNT; i++)
+    {
+        Finished->Mah[i] = EnergyMah(i, EnergyStats.Ms[i]);
+        DayMah += Finished->Mah[i];
+        EnergyStats.Ms[i] = 0;
+    }
+    EnergyStats.TotalMah += DayMah;
+    EnergyStats.Day = NewDay;
+    LOG_I("Energy: %.2f mAh consumed on the previous day", DayMah);
+}
+
+// Finish the current day if the date has changed
+static void EnergyDayCheck()
+{
+    if (!ClockValid())
+    {
+        return;
+    }
+    uint32_t Today = (uint32_t)(ClockNow() / 86400);
+    if (EnergyStats.Day == 0)
+    {
+        EnergyStats.Day = Today;
+    }
+    if (Today != EnergyStats.Day)
+    {
+        EnergyRollover(Today);
+    }
+}
+
+void EnergyHandle()
+{
+    uint32_t Elapsed = millis() - EnergyLastMillis;
+    EnergyLastMillis += Elapsed;
+    Elapsed = (Elapsed > EnergyAccounted) ? Elapsed - EnergyAccounted : 0;
+    EnergyAccounted = 0;
+    int State = EN_SESSION;
+    if (NetState == NET_DOWN)
+    {
+        State = EN_ACTIVE;
+    }
+#ifdef CONNECTED_IDLE
+    else if (ConnectedIdle())
+    {
+        State = EN_IDLE;
+    }
+#endif
+    EnergyStats.Ms[State] += Elapsed;
+    EnergyDayCheck();
+}
+
+void EnergyAdd(int State, uint32_t Ms)
+{
+    EnergyStats.Ms[State] += Ms;
+    EnergyAccounted += Ms;
+}
+
+void EnergyOn(int Consumer, bool On)
+{
+    if (On && EnergyOnMillis[Consumer] == 0)
+    {
+        EnergyOnMillis[Consumer] = millis() | 1;
+    }
+    else if (!On && EnergyOnMillis[Consumer] != 0)
+    {
+        EnergyStats.Ms[Consumer] += millis() - EnergyOnMillis[Consumer];
+        EnergyOnMillis[Consumer] = 0;
+    }
+}
+
+void EnergySleep(uint64_t SleepUs)
+{
+    EnergyHandle();
+    EnergyOn(EN_EPAPER, false);
+    EnergyOn(EN_LED, false);
+    EnergyStats.SleepUs = SleepUs;
+    EnergyStats.SleepStart = ClockValid() ? ClockNow() : 0;
+}
+
+void EnergyBoot()
+{
+    if (EnergyStats.Magic != EN_MAGIC)
+    {
+        // first boot after power loss (battery change)
+        memset((void *)&EnergyStats, 0, sizeof(EnergyRecord));
+        EnergyStats.Magic = EN_MAGIC;
+        return;
+    }
+    if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_UNDEFINED)
+    {
+        // reset without DeepSleep
+        return;
+    }
+    if (EnergyStats.SleepStart != 0 && EnergyStats.Day != 0 && ClockValid() && ClockNow() >= EnergyStats.SleepStart)
+    {
+        // measured duration also covers early (button) wakeups; split it at midnight, so each day gets its share
+        time_t From = EnergyStats.SleepStart;
+        time_t To = ClockNow();
+        while (From < To)
+        {
+            time_t DayEnd = (time_t)(EnergyStats.Day + 1) * 86400;
+            time_t PartEnd = min(To, DayEnd);
+            if (PartEnd > From)
+            {
+                EnergyStats.Ms[EN_SLEEP] += (uint32_t)(PartEnd - From) * 1000UL;
+                From = PartEnd;
+            }
+            if (From >= DayEnd)
+            {
+                EnergyRollover(EnergyStats.Day + 1);
+            }
+        }
+    }
+    else
+    {
+        EnergyStats.Ms[EN_SLEEP] += (uint32_t)(EnergyStats.SleepUs / 1000ULL);
+    }
+    EnergyStats.SleepUs = 0;
+    EnergyStats.SleepStart = 0;
+}
+
+void EnergyPublish()
+{
+    // oldest day first, the retained message ends up with the latest one
+    while (EnergyStats.PendingCnt > 0)
+    {
+        EnergyDay *Finished = &EnergyStats.Pending[0];
+        // Runtime projection based on the finished day
+        float DayMah = 0;
+        for (int i = 0; i < EN_CNT; i++)
+        {
+            DayMah += Finished->Mah[i];
+        }
+        float Remaining = EN_BATTERY_MAH - EnergyStats.TotalMah;
+        float Days = (DayMah > 0 && Remaining > 0) ? Remaining / DayMah : 0;
+
+        char Msg[20 + (EN_CNT + 2) * 10];
+        int Len = snprintf(Msg, sizeof(Msg), "%lx", (unsigned long)Finished->Day * 86400UL);
+        for (int i = 0; i < EN_CNT; i++)
+        {
+            Len += snprintf(&Msg[Len], sizeof(Msg) - Len, ";%.2f", Finished->Mah[i]);
+        }
+        snprintf(&Msg[Len], sizeof(Msg) - Len, ";%.2f;%.0f", DayMah, Days);
+        if (!mqttClt.publish(energy_topic, Msg, true))
+        {
+            return;
+        }
+        LOG_I("Energy: %.2f mAh per day, projected runtime %.0f days", DayMah, Days);
+        EnergyStats.PendingCnt--;
+        memmove(&EnergyStats.Pending[0], &EnergyStats.Pending[1], sizeof(EnergyDay) * EnergyStats.PendingCnt);
+    }
+}
+#endif // ENERGY_STATS
@@ -0,0 +1,95 @@
+/*
+ * ESP32 Rememberall
+ * NVS backed event store
+ */
+#include "eventstore.h"
+#include "generic-config.h"
+
+// Shadow copy of the event record stored in NVS
+EventStoreRecord EvsStored;
+// Current (pending) record
+EventStoreRecord EvsPending;
+bool EvsDirty = false;
+unsigned long EvsLastChange = 0;
+
+bool EventStoreLoad(EventStoreRecord *Record)
+{
+    Preferences Nvs;
+    bool RetVal = false;
+    memset((void *)&EvsStored, 0, sizeof(EvsStored));
+    if (Nvs.begin(NVS_NAMESPACE, true))
+    {
+        // Stored record must match size and version of the current firmware
+        if (Nvs.getBytesLength(EVS_KEY) == sizeof(EventStoreRecord) &&
+            Nvs.getBytes(EVS_KEY, &EvsStored, sizeof(EventStoreRecord)) == sizeof(EventStoreRecord) &&
+            EvsStored.Version == EVS_VERSION)
+        {
+            RetVal = true;
+        }
+        else
+        {
+            LOG_I("EventStore: no valid event stored in NVS");
+            memset((void *)&EvsStored, 0, sizeof(EvsStored));
+        }
+        Nvs.end();
+    }
+    memcpy((void *)&EvsPending, &EvsStored, sizeof(EventStoreRecord));
+    memcpy((void *)Record, &EvsStored, sizeof(EventStoreRecord));
+    return RetVal;
+}
+
+void EventStoreUpdate(bool TxtValid, bool ReminderValid, bool Acknowledged, eventInfoStruct *EventData)
+{
+    if (!TxtValid && !ReminderValid && EvsStored.Version != EVS_VERSION)
+    {
+        // nothing decoded yet and nothing stored, don't write an empty record
+        return;
+    }
+    // build record with zeroed padding to allow comparison with memcmp
+    EventStoreRecord Record;
+    memset((void *)&Record, 0, sizeof(Record));
+    Record.Version = EVS_VERSION;
+    Record.TxtValid = TxtValid;
+    Record.ReminderValid = ReminderValid;
+    Record.Acknowledged = Acknowledged;
+    memcpy((void *)&Record.EventInfo, EventData, sizeof(eventInfoStruct));
+    if (memcmp(&Record, &EvsPending, sizeof(EventStoreRecord)) != 0)
+    {
+        memcpy((void *)&EvsPending, &Record, sizeof(EventStoreRecord));
+        EvsDirty = true;
+        EvsLastChange = millis();
+    }
+}
+
+void EventStoreHandle(bool Flush)
+{
+    if (!EvsDirty)
+    {
+        return;
+    }
+    if (!Flush && (millis() - EvsLastChange) < EVS_COALESCE_MS)
+    {
+        // wait for further updates
+        return;
+    }
+    EvsDirty = false;
+    if (memcmp(&EvsPending, &EvsStored, sizeof(EventStoreRecord)) == 0)
+    {
+        // changes have been reverted in the meantime, nothing to write
+        return;
+    }
+    Preferences Nvs;
+    if (Nvs.begin(NVS_NAMESPACE, false))
+    {
+        if (Nvs.putBytes(EVS_KEY, &EvsPending, sizeof(EventStoreRecord)) == sizeof(EventStoreRecord))
+        {
+            memcpy((void *)&EvsStored, &EvsPending, sizeof(EventStoreRecord));
+            LOG_D("EventStore: event written to NVS");
+        }
+        else
+        {
+            LOG_E("EventStore: failed to write event to NVS");
+        }
+        Nvs.end();
+    }
+}
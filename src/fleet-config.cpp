@@ -0,0 +1,165 @@
+/*
+ * ESP32 Rememberall
+ * Fleet mode runtime configuration
+ */
+#include "setup.h"
+#include "fleet-config.h"
+
+#ifdef FLEET_MODE
+FleetConfig FleetCfg;
+char FleetCfgTopic[sizeof(FLEET_CFG_TOPTREE) + 12];
+char FleetCfgMsg[MQTT_RCV_BUF_SIZE];
+MqttSubCfg *FleetCfgSub = NULL;
+uint32_t FleetCfgMsgHandled = 0;
+
+// Fill config with compile time defaults
+void FleetConfigDefaults(FleetConfig *Cfg, const char *Mac)
+{
+    memset((void *)Cfg, 0, sizeof(FleetConfig));
+    Cfg->Version = FLEET_VERSION;
+    snprintf(Cfg->ClientName, sizeof(Cfg->ClientName), "%s%s", FLEET_CLTNAME_PREFIX, &Mac[6]);
+    snprintf(Cfg->TopTree, sizeof(Cfg->TopTree), "%s%s/", FLEET_DEF_TOPTREE, Cfg->ClientName);
+    Cfg->WifiSleepDuration = WIFI_SLEEP_DURATION;
+    Cfg->LedBrightness = FL_GLOBAL_BRIGHTNESS;
+    Cfg->BeatsinCosy = FL_RING_BEATSIN_COSY;
+    Cfg->BeatsinAggro = FL_RING_BEATSIN_AGGRO;
+    Cfg->DisplayRotation = D_LANDSCAPE_ROT;
+}
+
+// Find the configuration topic in MqttSubscriptions
+void FleetConfigFindSub()
+{
+    for (int i = 0; i < SubscribedTopicCnt; i++)
+    {
+        if (MqttSubscriptions[i].stringPtr == FleetCfgMsg)
+        {
+            FleetCfgSub = &MqttSubscriptions[i];
+        }
+    }
+}
+
+void FleetConfigLoad()
+{
+    char Mac[13];
+    uint64_t EfuseMac = ESP.getEfuseMac();
+    for (int i = 0; i < 6; i++)
+    {
+        snprintf(&Mac[i * 2], 3, "%02X", (unsigned)((EfuseMac >> (8 * i)) & 0xFF));
+    }
+    snprintf(FleetCfgTopic, sizeof(FleetCfgTopic), "%s%s", FLEET_CFG_TOPTREE, Mac);
+
+    Preferences Nvs;
+    bool Loaded = false;
+    if (Nvs.begin(NVS_NAMESPACE, true))
+    {
+        // Stored config must match size and version of the current firmware
+        Loaded = (Nvs.getBytesLength(FLEET_KEY) == sizeof(FleetConfig) &&
+                  Nvs.getBytes(FLEET_KEY, &FleetCfg, sizeof(FleetConfig)) == sizeof(FleetConfig) &&
+                  FleetCfg.Version == FLEET_VERSION);
+        Nvs.end();
+    }
+    if (!Loaded)
+    {
+        FleetConfigDefaults(&FleetCfg, Mac);
+        LOG_W("Fleet: not provisioned, publish configuration to %s", FleetCfgTopic);
+    }
+    FleetConfigFindSub();
+    if (Loaded && esp_reset_reason() == ESP_RST_DEEPSLEEP)
+    {
+        // provisioned, only check for a new configuration after power-on or reset
+        FleetCfgSub->Deferred = true;
+    }
+    LOG_I("Fleet: client %s, topic tree %s", FleetCfg.ClientName, FleetCfg.TopTree);
+}
+
+// Decode configuration message, returns false on invalid input
+bool FleetConfigDecode(char *Msg, FleetConfig *Cfg)
+{
+    char *Token[7];
+    for (int i = 0; i < 7; i++)
+    {
+        Token[i] = strtok(i == 0 ? Msg : NULL, ";");
+        if (Token[i] == NULL)
+        {
+            return false;
+        }
+    }
+    size_t TopTreeLen = strlen(Token[0]);
+    if (TopTreeLen == 0 || TopTreeLen >= sizeof(Cfg->TopTree) || Token[0][TopTreeLen - 1] != '/' ||
+        strlen(Token[1]) == 0 || strlen(Token[1]) >= sizeof(Cfg->ClientName))
+    {
+        return false;
+    }
+    long Values[5];
+    for (int i = 0; i < 5; i++)
+    {
+        Values[i] = strtol(Token[i + 2], NULL, 10);
+    }
+    if (Values[0] < 60 || Values[0] > 86400 || Values[1] < 1 || Values[1] > 255 ||
+        Values[2] < 1 || Values[2] > 255 || Values[3] < 1 || Values[3] > 255 || Values[4] < 0 || Values[4] > 3)
+    {
+        return false;
+    }
+    // zeroed padding allows comparison with memcmp
+    memset((void *)Cfg, 0, sizeof(FleetConfig));
+    Cfg->Version = FLEET_VERSION;
+    strlcpy(Cfg->TopTree, Token[0], sizeof(Cfg->TopTree));
+    strlcpy(Cfg->ClientName, Token[1], sizeof(Cfg->ClientName));
+    Cfg->WifiSleepDuration = (uint32_t)Values[0];
+    Cfg->LedBrightness = (uint8_t)Values[1];
+    Cfg->BeatsinCosy = (uint8_t)Values[2];
+    Cfg->BeatsinAggro = (uint8_t)Values[3];
+    Cfg->DisplayRotation = (uint8_t)Values[4];
+    return true;
+}
+
+void FleetConfigHandle()
+{
+    // MsgRcvd is reset on reconnect, so check for any change
+    if (FleetCfgSub->MsgRcvd == 0 || FleetCfgSub->MsgRcvd == FleetCfgMsgHandled)
+    {
+        return;
+    }
+    FleetCfgMsgHandled = FleetCfgSub->MsgRcvd;
+    char Msg[MQTT_RCV_BUF_SIZE];
+    strlcpy(Msg, FleetCfgMsg, sizeof(Msg));
+    FleetConfig Cfg;
+    if (!FleetConfigDecode(Msg, &Cfg))
+    {
+        LOG_E("Fleet: invalid configuration: %s", FleetCfgMsg);
+        return;
+    }
+    if (memcmp(&Cfg, &FleetCfg, sizeof(FleetConfig)) == 0)
+    {
+        // already active
+        return;
+    }
+    Preferences Nvs;
+    if (!Nvs.begin(NVS_NAMESPACE, false))
+    {
+        LOG_E("Fleet: unable to open NVS");
+        return;
+    }
+    bool Stored = (Nvs.putBytes(FLEET_KEY, &Cfg, sizeof(FleetConfig)) == sizeof(FleetConfig));
+    Nvs.end();
+    if (!Stored)
+    {
+        LOG_E("Fleet: failed to write configuration to NVS");
+        return;
+    }
+    LOG_I("Fleet: new configuration stored (client %s, topic tree %s), restarting", Cfg.ClientName, Cfg.TopTree);
+    delay(200);
+    LogFlush();
+    ESP.restart();
+}
+
+const char *FleetTopic(const char *Topic, char *Buf, size_t BufLen)
+{
+    if (strncmp(Topic, FLEET_TOPTREE_MARK, sizeof(FLEET_TOPTREE_MARK) - 1) != 0)
+    {
+        return Topic;
+    }
+    snprintf(Buf, BufLen, "%s%s", FleetCfg.TopTree, Topic + sizeof(FLEET_TOPTREE_MARK) - 1);
+    return Buf;
+}
+#endif // FLEET_MODE
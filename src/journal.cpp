@@ -0,0 +1,109 @@
+/*
+ * ESP32 Rememberall
+ * User action journal
+ */
+#include "setup.h"
+#include "journal.h"
+
+JournalStruct Journal;
+
+// Write journal to NVS
+void JournalSave()
+{
+    Preferences Nvs;
+    if (Nvs.begin(NVS_NAMESPACE, false))
+    {
+        if (Nvs.putBytes(JRN_KEY, &Journal, sizeof(JournalStruct)) != sizeof(JournalStruct))
+        {
+            LOG_E("Journal: failed to write to NVS");
+        }
+        Nvs.end();
+    }
+}
+
+void JournalLoad()
+{
+    Preferences Nvs;
+    memset((void *)&Journal, 0, sizeof(JournalStruct));
+    Journal.NextSeq = 1;
+    if (Nvs.begin(NVS_NAMESPACE, true))
+    {
+        if (Nvs.getBytesLength(JRN_KEY) != sizeof(JournalStruct) ||
+            Nvs.getBytes(JRN_KEY, &Journal, sizeof(JournalStruct)) != sizeof(JournalStruct))
+        {
+            LOG_I("Journal: no journal stored in NVS");
+            memset((void *)&Journal, 0, sizeof(JournalStruct));
+            Journal.NextSeq = 1;
+        }
+        Nvs.end();
+    }
+}
+
+void JournalAdd(char Action, time_t Epoch, time_t Deadline)
+{
+    JournalEntry *Entry = &Journal.Entries[Journal.NextSeq % JRN_SIZE];
+    Entry->Seq = Journal.NextSeq;
+    Entry->Action = Action;
+    Entry->Epoch = Epoch;
+    Entry->Deadline = Deadline;
+    Journal.NextSeq++;
+    JournalSave();
+    LOG_D("Journal: added action %c with Seq %lu", Action, (unsigned long)Entry->Seq);
+}
+
+bool JournalPending()
+{
+    return (Journal.SentSeq + 1 < Journal.NextSeq);
+}
+
+bool JournalHasAck(time_t Deadline)
+{
+    for (int i = 0; i < JRN_SIZE; i++)
+    {
+        if (Journal.Entries[i].Seq > 0 && Journal.Entries[i].Action == JRN_ACK && Journal.Entries[i].Deadline == Deadline)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool JournalReplay(time_t CurrentDeadline)
+{
+    // Build message, oldest entry first
+    char JrnMsg[JRN_SIZE * 32];
+    size_t Len = 0;
+    bool AckCurrentEvent = false;
+    JrnMsg[0] = '\0';
+    uint32_t FirstSeq = (Journal.NextSeq > JRN_SIZE) ? Journal.NextSeq - JRN_SIZE : 1;
+    for (uint32_t Seq = FirstSeq; Seq < Journal.NextSeq; Seq++)
+    {
+        JournalEntry *Entry = &Journal.Entries[Seq % JRN_SIZE];
+        if (Entry->Seq != Seq)
+        {
+            continue;
+        }
+        Len += snprintf(&JrnMsg[Len], sizeof(JrnMsg) - Len, "%s%lx;%c;%lx;%lx", (Len > 0) ? "|" : "",
+                        (unsigned long)Entry->Seq, Entry->Action, (unsigned long)Entry->Epoch, (unsigned long)Entry->Deadline);
+        if (Entry->Seq > Journal.SentSeq && Entry->Action == JRN_ACK && Entry->Deadline == CurrentDeadline)
+        {
+            AckCurrentEvent = true;
+        }
+    }
+    if (AckCurrentEvent)
+    {
+        // Keep Status topic up to date for the feeder
+        if (!mqttClt.publish(Status_topic, "ack", true))
+        {
+            return false;
+        }
+    }
+    if (!mqttClt.publish(Journal_topic, JrnMsg, true))
+    {
+        return false;
+    }
+    Journal.SentSeq = Journal.NextSeq - 1;
+    JournalSave();
+    LOG_D("Journal: published %s", JrnMsg);
+    return true;
+}
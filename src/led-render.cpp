@@ -0,0 +1,105 @@
+/*
+ * ESP32 Rememberall
+ * LED ring rendering stage
+ */
+#include "led-render.h"
+#include "generic-config.h"
+
+#ifdef LED_RENDER
+#define LED_FRAME_US (1000000UL / LED_RENDER_FPS)
+#define LED_FRAC_MASK ((0xFF << (8 - LED_DITHER_BITS)) & 0xFF) // fraction bits kept in the LUT
+
+CRGB LedOut[FL_RING_NUM_LEDS];
+static uint16_t LedLut[3][256];              // 8.8 fixed point output per channel (R, G, B) and input value
+static uint8_t LedErr[FL_RING_NUM_LEDS][3];  // accumulated fraction per LED and channel
+static int LedLutBrightness = -1;
+static uint32_t LedNextFrameUs = 0;
+static bool LedDither = false; // last frame was on time
+
+void LedRenderBegin(uint8_t Brightness)
+{
+    if (Brightness == LedLutBrightness)
+    {
+        return;
+    }
+    const uint8_t Wb[3] = {(LED_WHITE_BALANCE >> 16) & 0xFF, (LED_WHITE_BALANCE >> 8) & 0xFF, LED_WHITE_BALANCE & 0xFF};
+    const float Round = (float)(1 << (8 - LED_DITHER_BITS)) / 2.0f;
+    for (int v = 0; v < 256; v++)
+    {
+        // output steps * 256 at full brightness and white balance
+        float Out = powf((float)v / 255.0f, LED_GAMMA) * 255.0f * 256.0f;
+        for (int c = 0; c < 3; c++)
+        {
+            uint32_t Val = (uint32_t)(Out * Brightness / 255.0f * Wb[c] / 255.0f + Round);
+            Val = (Val & 0xFF00) | (Val & LED_FRAC_MASK);
+            LedLut[c][v] = (uint16_t)min(Val, (uint32_t)0xFF00);
+        }
+    }
+    memset(LedErr, 0, sizeof(LedErr));
+    LedLutBrightness = Brightness;
+}
+
+uint8_t LedRenderDue()
+{
+    uint32_t Now = micros();
+    if ((int32_t)(Now - LedNextFrameUs) < 0)
+    {
+        return 0;
+    }
+    // frame periods since the last frame
+    uint32_t Frames = (Now - LedNextFrameUs) / LED_FRAME_US + 1;
+    LedDither = (Frames == 1);
+    if (LedDither)
+    {
+        LedNextFrameUs += LED_FRAME_US;
+    }
+    else
+    {
+        // late (e.g. blocked by an ePaper refresh or a delay in the main loop), restart the cadence
+        LedNextFrameUs = Now + LED_FRAME_US;
+    }
+    return (uint8_t)min(Frames, (uint32_t)255);
+}
+
+uint8_t LedRenderFade(uint8_t Frames)
+{
+    // remaining brightness after Frames times fadeToBlackBy(LED_RENDER_FADE), 8.8 fixed point
+    uint32_t Keep = 256;
+    for (int i = 0; i < Frames && Keep > 0; i++)
+    {
+        Keep = (Keep * (256 - LED_RENDER_FADE)) >> 8;
+    }
+    return (uint8_t)min(256 - Keep, (uint32_t)255);
+}
+
+void LedRenderShow(const CRGB *Src)
+{
+    if (!LedDither)
+    {
+        // a dither cycle spread over late frames would be visible as flicker, round instead
+        for (int i = 0; i < FL_RING_NUM_LEDS; i++)
+        {
+            LedOut[i].r = (LedLut[0][Src[i].r] + 0x80) >> 8;
+            LedOut[i].g = (LedLut[1][Src[i].g] + 0x80) >> 8;
+            LedOut[i].b = (LedLut[2][Src[i].b] + 0x80) >> 8;
+        }
+        memset(LedErr, 0, sizeof(LedErr));
+        FastLED.show();
+        return;
+    }
+    for (int i = 0; i < FL_RING_NUM_LEDS; i++)
+    {
+        // LUT values are <= 0xFF00, so the sum can't overflow and the integer part is a valid output value
+        uint16_t R = LedLut[0][Src[i].r] + LedErr[i][0];
+        uint16_t G = LedLut[1][Src[i].g] + LedErr[i][1];
+        uint16_t B = LedLut[2][Src[i].b] + LedErr[i][2];
+        LedOut[i].r = R >> 8;
+        LedOut[i].g = G >> 8;
+        LedOut[i].b = B >> 8;
+        LedErr[i][0] = R & 0xFF;
+        LedErr[i][1] = G & 0xFF;
+        LedErr[i][2] = B & 0xFF;
+    }
+    FastLED.show();
+}
+#endif // LED_RENDER
@@ -0,0 +1,170 @@
+/*
+ * ESP32 Template
+ * Structured logger
+ */
+#include "setup.h"
+#include "logger.h"
+#include <atomic>
+#include <stdarg.h>
+
+#if LOG_LEVEL > LOG_LVL_NONE
+struct LogRecord
+{
+    std::atomic<bool> Ready; // record completely written by producer
+    uint8_t Level;           // LOG_LVL_x
+    uint32_t Millis;         // uptime when the record was written
+    char Msg[LOG_MSG_SIZE];  // formatted message
+};
+
+// Lock-free ring buffer: multiple producers reserve slots by advancing LogHead, a single consumer advances LogTail
+LogRecord LogRing[LOG_RING_SIZE];
+std::atomic<uint32_t> LogHead(0);
+std::atomic<uint32_t> LogTail(0);
+std::atomic<uint32_t> LogDropped(0);
+std::atomic_flag LogDraining = ATOMIC_FLAG_INIT; // guards the single consumer (logger task / LogFlush)
+const char LogLevelChar[] = {'-', 'E', 'W', 'I', 'D'};
+
+// Write one record to the enabled sinks
+void LogOutput(LogRecord *Rec, bool Online)
+{
+#ifdef SERIAL_OUT
+    char Hdr[16];
+    int Len = snprintf(Hdr, sizeof(Hdr), "%lu %c ", (unsigned long)Rec->Millis, LogLevelChar[Rec->Level]);
+    Serial.write((const uint8_t *)Hdr, Len);
+    Serial.write((const uint8_t *)Rec->Msg, strlen(Rec->Msg));
+    Serial.write('\n');
+#endif
+#ifdef LOG_MQTT
+    if (Online)
+    {
+        char LogMsg[LOG_MSG_SIZE + 16];
+        snprintf(LogMsg, sizeof(LogMsg), "%lu;%c;%s", (unsigned long)Rec->Millis, LogLevelChar[Rec->Level], Rec->Msg);
+        mqttClt.publish(log_topic, LogMsg, false);
+    }
+#endif
+}
+
+// Consume all completely written records; returns the number of records written to the sinks
+uint32_t LogDrain(bool Online)
+{
+    uint32_t Cnt = 0;
+    if (LogDraining.test_and_set(std::memory_order_acquire))
+    {
+        // already draining in another task
+        return 0;
+    }
+    uint32_t Dropped = LogDropped.exchange(0);
+    if (Dropped > 0)
+    {
+        LOG_W("Logger: %lu records dropped", (unsigned long)Dropped);
+    }
+    uint32_t Tail = LogTail.load(std::memory_order_relaxed);
+    while (Tail != LogHead.load(std::memory_order_acquire))
+    {
+        LogRecord *Rec = &LogRing[Tail % LOG_RING_SIZE];
+        if (!Rec->Ready.load(std::memory_order_acquire))
+        {
+            // producer still writing
+            break;
+        }
+        LogOutput(Rec, Online);
+        Rec->Ready.store(false, std::memory_order_relaxed);
+        Tail++;
+        LogTail.store(Tail, std::memory_order_release);
+        Cnt++;
+    }
+    LogDraining.clear(std::memory_order_release);
+    return Cnt;
+}
+
+#ifndef LOG_MQTT
+// Low priority task draining the ring to Serial
+void LogTask(void *Param)
+{
+    while (true)
+    {
+        LogDrain(false);
+        vTaskDelay(pdMS_TO_TICKS(LOG_TASK_INTERVAL));
+    }
+}
+#endif
+
+void LogSetup()
+{
+#ifndef LOG_MQTT
+    xTaskCreate(LogTask, "LogTask", LOG_TASK_STACK, NULL, tskIDLE_PRIORITY + 1, NULL);
+#endif
+}
+
+void LogWrite(uint8_t Level, const char *Fmt, ...)
+{
+    // reserve a slot
+    uint32_t Slot = LogHead.load(std::memory_order_relaxed);
+    do
+    {
+        if (Slot - LogTail.load(std::memory_order_acquire) >= LOG_RING_SIZE)
+        {
+            LogDropped++;
+            return;
+        }
+    } while (!LogHead.compare_exchange_weak(Slot, Slot + 1, std::memory_order_acq_rel));
+    LogRecord *Rec = &LogRing[Slot % LOG_RING_SIZE];
+    Rec->Level = Level;
+    Rec->Millis = millis();
+    va_list Args;
+    va_start(Args, Fmt);
+    vsnprintf(Rec->Msg, sizeof(Rec->Msg), Fmt, Args);
+    va_end(Args);
+    Rec->Ready.store(true, std::memory_order_release);
+}
+
+void LogHandle(bool Online)
+{
+#ifdef LOG_MQTT
+    LogDrain(Online);
+#endif
+}
+
+void LogFlush()
+{
+    // Drain until the ring is empty; records written meanwhile (e.g. the dropped records warning) are flushed as well.
+    // Gives up after LOG_FLUSH_MAX records or if no record can be consumed for LOG_FLUSH_WAIT ms
+    // (logger task draining or a producer still writing).
+    uint32_t Flushed = 0;
+    uint32_t Waited = 0;
+    while (LogTail.load() != LogHead.load() || LogDropped.load() > 0)
+    {
+#ifdef LOG_MQTT
+        uint32_t Cnt = LogDrain(NetState == NET_UP);
+#else
+        uint32_t Cnt = LogDrain(false);
+#endif
+        Flushed += Cnt;
+        if (Flushed >= LOG_FLUSH_MAX || Waited >= LOG_FLUSH_WAIT)
+        {
+            break;
+        }
+        if (Cnt == 0)
+        {
+            delay(1);
+            Waited++;
+        }
+    }
+    uint32_t Lost = (LogHead.load() - LogTail.load()) + LogDropped.load();
+    if (Lost > 0)
+    {
+#ifdef SERIAL_OUT
+        Serial.printf("%lu W Logger: %lu records not flushed\n", (unsigned long)millis(), (unsigned long)Lost);
+#endif
+    }
+#ifdef SERIAL_OUT
+    Serial.flush();
+#endif
+}
+#else
+// Logging disabled
+void LogSetup() {}
+void LogWrite(uint8_t Level, const char *Fmt, ...) {}
+void LogHandle(bool Online) {}
+void LogFlush() {}
+#endif // LOG_LEVEL
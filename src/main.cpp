@@ -31,6 +31,10 @@ void loop()
     oldMillis = millis();
     UptimeSeconds++;
   }
+#ifdef ENERGY_STATS
+  // Account time spent since the last iteration
+  EnergyHandle();
+#endif
 
 //
 // Handle local tasks
@@ -72,6 +76,7 @@ void loop()
         // Still no network/broker available, wait for NET_RECONNECT_INTERVAL
         netfail_reconn_millis = millis() + NET_RECONNECT_INTERVAL;
         netfail_reconn_tries++;
+        DIAG_ADD(DIAG_NET, DIAG_NET_RECONN, netfail_reconn_tries);
 #ifdef MAX_NETFAIL_RECONN
         if (netfail_reconn_tries > MAX_NETFAIL_RECONN)
         {
@@ -104,6 +109,14 @@ void loop()
       // OTA Update in progress, restart main loop
       return;
     }
+#ifdef FLEET_MODE
+    // Apply newly provisioned device configuration
+    FleetConfigHandle();
+#endif
+#ifdef OTA_PULL
+    // Download OTA image in chunks (user_loop keeps running)
+    OtaPullHandle();
+#endif
 #ifdef READVCC
     // Publish VCC to MQTT
     static unsigned long Next_Mqtt_Publish = 0;
@@ -112,26 +125,44 @@ void loop()
       mqttClt.publish(vcc_topic, String(VCC).c_str(), true);
       delay(150);
       Next_Mqtt_Publish = millis() + (MQTT_PUB_INTERVAL * 1000);
-      DEBUG_PRINTLN("VCC = " + String(VCC) + " V");
+      LOG_D("VCC = %.2f V", VCC);
     }
 #endif
-  }
-#ifdef NTP_CLT
-  // Always update time variables, also when WiFi is off
-  time(&EpochTime);
-  getLocalTime(&TimeInfo, 200);
-  if (TimeInfo.tm_year > 2023)
-  {
-    // System time is in the past, somethings wrong - retry
-    getLocalTime(&TimeInfo, 200);
-    if (TimeInfo.tm_year > 2023)
+#ifdef DIAG_RING
+    // Publish diagnostic records if requested
+    DiagHandle();
+#endif
+#ifdef ULP_MONITOR
+    // Publish VBAT samples taken by the ULP during DeepSleep
+    UlpMonitorPublish();
+#endif
+#ifdef ENERGY_STATS
+    // Publish energy breakdown of the previous day
+    EnergyPublish();
+#endif
+#ifdef MEM_REPORT
+    // Publish heap statistics to MQTT
+    static unsigned long Next_Mem_Publish = 0;
+    if (millis() >= Next_Mem_Publish)
     {
-      DEBUG_PRINTLN("Wrong system time, invalidating local time and retry in next loop");
-      NTPSyncCounter = 0;
+      PublishMemStats();
+      Next_Mem_Publish = millis() + (MQTT_PUB_INTERVAL * 1000);
     }
+#endif
   }
+#ifdef LOG_MQTT
+  // Drain log records, publish them if connected to the broker
+  LogHandle(NetState == NET_UP && mqttClt.connected());
+#endif
+#ifdef NTP_CLT
+  // Always update time, also when WiFi is off
+  ClockUpdate();
   // Prints formatted date and time
-  // DEBUG_PRINTLN(&TimeInfo, "%A, %B %d %Y %H:%M:%S");
+  // LOG_D("%04d-%02d-%02d %02d:%02d:%02d", ClockTimeInfo()->tm_year + 1900, ClockTimeInfo()->tm_mon + 1, ClockTimeInfo()->tm_mday, ClockTimeInfo()->tm_hour, ClockTimeInfo()->tm_min, ClockTimeInfo()->tm_sec);
+#endif
+#ifdef RTC_DRIFT_LEARNING
+  // Learn RTC clock skew from the last DeepSleep after NTP sync
+  DriftLearn();
 #endif
 #ifdef MEASURE_SLEEP_CLOCK_SKEW
   static bool SkewDataSent = false;
@@ -141,7 +172,7 @@ void loop()
     if (NTPSyncCounter > 0 && !SkewDataSent)
     {
       mqttClt.publish(boot_dur_topic, String(millis()).c_str(), false);
-      mqttClt.publish(end_sleep_topic, String(EpochTime).c_str(), false);
+      mqttClt.publish(end_sleep_topic, String(ClockNow()).c_str(), false);
       SkewDataSent = true;
     }
   }
@@ -165,26 +196,32 @@ void loop()
   user_loop();
   yield();
 #endif
+#ifdef CONNECTED_IDLE
+  // Let the CPU idle (or light sleep) between beacons, unless user_loop is busy
+  if (ConnectedIdle() && !ConnectedIdleBusy)
+  {
+    delay(CI_LOOP_DELAY);
+  }
+#endif
 
 //
 // Handle SleepUntil
 //
 #ifdef SLEEP_UNTIL
-  if (NTPSyncCounter > 0 && EpochTime < SleepUntilEpoch && !DelayDeepSleep)
+  if (ClockValid() && !TimeResyncDue() && ClockNow() < SleepUntilEpoch && !DelayDeepSleep)
   {
-    time(&EpochTime);
+    ClockUpdate();
+    time_t Now = ClockNow();
     // System time synced and received sleep-until time in the future -> OK!
-    // calculate time to sleep in µs
-    uint64_t WakeAfter_us = (((uint64_t)SleepUntilEpoch - (uint64_t)EpochTime) * 1000000ULL);
 #ifdef MEASURE_SLEEP_CLOCK_SKEW
-    DEBUG_PRINTLN("Configured Sleep time in seconds: " + String(SleepUntilEpoch - EpochTime));
-    DEBUG_PRINTLN("Epoch at start sleep: " + String(EpochTime));
-    mqttClt.publish(set_sleep_dur_topic, String(SleepUntilEpoch - EpochTime).c_str(), false);
-    mqttClt.publish(start_sleep_topic, String(EpochTime).c_str(), false);
+    LOG_I("Configured Sleep time in seconds: %ld", (long)(SleepUntilEpoch - Now));
+    LOG_I("Epoch at start sleep: %ld", (long)Now);
+    mqttClt.publish(set_sleep_dur_topic, String(SleepUntilEpoch - Now).c_str(), false);
+    mqttClt.publish(start_sleep_topic, String(Now).c_str(), false);
     delay(100);
 #endif
     wifi_down();
-    esp_deep_sleep(WakeAfter_us);
+    EnterDeepSleep((uint32_t)(SleepUntilEpoch - Now), -1);
   }
 #endif
 
@@ -195,9 +232,9 @@ void loop()
   if (!DelayDeepSleep)
   {
     // disconnect WiFi and go to sleep
-    DEBUG_PRINTLN("Good night for " + String(DS_DURATION_MIN) + " minutes.");
+    LOG_I("Good night for %d minutes.", DS_DURATION_MIN);
     wifi_down();
-    esp_deep_sleep((uint64_t)DS_DURATION_MIN * 60000000ULL);
+    EnterDeepSleep(DS_DURATION_MIN * 60, -1);
   }
 #endif
 
@@ -0,0 +1,70 @@
+/*
+ * ESP32 Rememberall
+ * Content manifest
+ */
+#include "manifest.h"
+#include "generic-config.h"
+
+#ifdef CONTENT_MANIFEST
+// Hashes of the decoded topic messages (kept during DeepSleep)
+RTC_DATA_ATTR uint32_t MnfDecodedHash[MNF_TOPIC_CNT];
+RTC_DATA_ATTR bool MnfDecodedValid[MNF_TOPIC_CNT];
+
+// FNV-1a (32 bit)
+uint32_t ManifestHash(const char *Msg)
+{
+    uint32_t Hash = 2166136261UL;
+    while (*Msg)
+    {
+        Hash ^= (uint8_t)*Msg++;
+        Hash *= 16777619UL;
+    }
+    return Hash;
+}
+
+bool ManifestDecode(const char *Msg, ContentManifest *Manifest)
+{
+    char Buf[MQTT_MAX_MSG_SIZE];
+    strlcpy(Buf, Msg, sizeof(Buf));
+    char *Token = strtok(Buf, ";");
+    for (int i = 0; i <= MNF_TOPIC_CNT; i++)
+    {
+        if (Token == NULL)
+        {
+            return false;
+        }
+        char *End;
+        uint32_t Value = (uint32_t)strtoul(Token, &End, 16);
+        if (*End != '\0')
+        {
+            return false;
+        }
+        if (i == 0)
+        {
+            Manifest->Version = Value;
+        }
+        else
+        {
+            Manifest->Hash[i - 1] = Value;
+        }
+        Token = strtok(NULL, ";");
+    }
+    return true;
+}
+
+bool ManifestCurrent(ContentManifest *Manifest, int Topic)
+{
+    return MnfDecodedValid[Topic] && MnfDecodedHash[Topic] == Manifest->Hash[Topic];
+}
+
+void ManifestDecoded(int Topic, const char *Msg)
+{
+    MnfDecodedHash[Topic] = ManifestHash(Msg);
+    MnfDecodedValid[Topic] = true;
+}
+
+bool ManifestKnown(int Topic, const char *Msg)
+{
+    return MnfDecodedValid[Topic] && MnfDecodedHash[Topic] == ManifestHash(Msg);
+}
+#endif // CONTENT_MANIFEST
@@ -4,6 +4,8 @@
  */
 #include "mqtt-ota-config.h"
 #include "user-config.h"
+#include "diag.h"
+#include "fleet-config.h"
 
 //
 // MqttSubscriptions is a dataset with all configuration information required
@@ -17,18 +19,15 @@
 //          2 = float
 //          3 = time_t (decoded as hex! message may start with "0x", upper/lower chars supported)
 //          4 = string (length limited to MQTT_MAX_MSG_SIZE!)
+//          5 = long string (length limited to MQTT_RCV_BUF_SIZE!)
 // .Subscribed: flag, true if successfully subscribed to topic (needs to be initialized as FALSE here!)
 // .MsgRcvd: Counts messages received for subscribed topic (needs to be initialized with 0 here!)
 // .[Bool|Int|Float|Time|string]Ptr: Pointer to a global var (according to "Type") where the decoded message info will be stored 
+// .Deferred: optional, set to true if the topic should only be subscribed on demand using MqttSubscribe (defaults to false)
+// .Optional: optional, set to true if the topic does not need a retained message, i.e. connecting does not wait for it (defaults to false)
 //
 
-#ifdef SLEEP_UNTIL
-const int SubscribedTopicCnt = 6; // Overall amount of topics to subscribe to
-#else
-const int SubscribedTopicCnt = 2; // Overall amount of topics to subscribe to
-#endif
-
-MqttSubCfg MqttSubscriptions[SubscribedTopicCnt]={
+MqttSubCfg MqttSubscriptions[]={
 #ifdef SLEEP_UNTIL
     {.Topic = sleep_until_topic, .Type = 3, .Subscribed = false, .MsgRcvd = 0, .TimePtr = &SleepUntilEpoch },
 #endif
@@ -36,5 +35,19 @@ MqttSubCfg MqttSubscriptions[SubscribedTopicCnt]={
     {.Topic = otaInProgress_topic, .Type = 0, .Subscribed = false, .MsgRcvd = 0, .BoolPtr = &OtaInProgress },
     {.Topic = eventTxt_topic, .Type = 4, .Subscribed = false, .MsgRcvd = 0, .stringPtr = &eventTxtMsg[0] },
     {.Topic = eventReminder_topic, .Type = 4, .Subscribed = false, .MsgRcvd = 0, .stringPtr = &eventReminderMsg[0] },
-    {.Topic = Status_topic, .Type = 4, .Subscribed = false, .MsgRcvd = 0, .stringPtr = &StatusMsg[0] }
+    {.Topic = Status_topic, .Type = 4, .Subscribed = false, .MsgRcvd = 0, .stringPtr = &StatusMsg[0] },
+#ifdef CONTENT_MANIFEST
+    {.Topic = Manifest_topic, .Type = 4, .Subscribed = false, .MsgRcvd = 0, .stringPtr = &ManifestMsg[0] },
+#endif
+#ifdef OTA_PULL
+    {.Topic = otaPull_topic, .Type = 5, .Subscribed = false, .MsgRcvd = 0, .stringPtr = &OtaPullMsg[0], .Optional = true },
+#endif
+#ifdef DIAG_RING
+    {.Topic = diag_req_topic, .Type = 0, .Subscribed = false, .MsgRcvd = 0, .BoolPtr = &DiagRequest, .Optional = true },
+#endif
+#ifdef FLEET_MODE
+    {.Topic = FleetCfgTopic, .Type = 5, .Subscribed = false, .MsgRcvd = 0, .stringPtr = &FleetCfgMsg[0], .Optional = true },
+#endif
 };
+
+const int SubscribedTopicCnt = sizeof(MqttSubscriptions) / sizeof(MqttSubCfg); // Overall amount of topics to subscribe to
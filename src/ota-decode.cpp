@@ -0,0 +1,263 @@
+/*
+ * ESP32 Template
+ * OTA image decoder (compressed images and deltas)
+ */
+#include "setup.h"
+#include "ota-decode.h"
+
+#ifdef OTA_PULL
+#include <Update.h>
+#include "esp_ota_ops.h"
+#include "esp_partition.h"
+#if CONFIG_IDF_TARGET_ESP32S2
+#include "esp32s2/rom/miniz.h"
+#else
+#include "esp32/rom/miniz.h"
+#endif
+
+enum OtaDecFormat
+{
+    OTA_FMT_DETECT, // waiting for the first bytes
+    OTA_FMT_IMAGE,  // plain firmware image
+    OTA_FMT_DELTA   // delta against running firmware
+};
+
+// Inflate state (zlib compressed downloads only)
+bool OtaDecZlib = false;
+bool OtaDecZlibDone = false;
+tinfl_decompressor *OtaInflator = NULL;
+uint8_t *OtaDict = NULL;
+size_t OtaDictOfs = 0;
+bool OtaDecFirstByte = true;
+
+// Patch state
+OtaDecFormat OtaDecFmt = OTA_FMT_DETECT;
+uint8_t OtaDecHdr[OTA_DELTA_HDR_SIZE]; // delta header or current op header
+size_t OtaDecHdrLen = 0;
+uint32_t OtaDecAddLeft = 0; // literal bytes left of the current ADD op
+const esp_partition_t *OtaRunning = NULL;
+
+uint32_t OtaGetU32(const uint8_t *Buf)
+{
+    return (uint32_t)Buf[0] | ((uint32_t)Buf[1] << 8) | ((uint32_t)Buf[2] << 16) | ((uint32_t)Buf[3] << 24);
+}
+
+bool OtaFlashWrite(const uint8_t *Data, size_t Len)
+{
+    return (Update.write((uint8_t *)Data, Len) == Len);
+}
+
+// Copy a range of the running firmware into the OTA partition
+bool OtaDeltaCopy(uint32_t Offset, uint32_t Len)
+{
+    uint8_t Buf[256];
+    if (Len > OtaRunning->size || Offset > OtaRunning->size - Len)
+    {
+        return false;
+    }
+    while (Len > 0)
+    {
+        uint32_t Part = min(Len, (uint32_t)sizeof(Buf));
+        if (esp_partition_read(OtaRunning, Offset, Buf, Part) != ESP_OK || !OtaFlashWrite(Buf, Part))
+        {
+            return false;
+        }
+        Offset += Part;
+        Len -= Part;
+    }
+    return true;
+}
+
+// Apply delta ops to decoded data
+bool OtaDeltaWrite(const uint8_t *Data, size_t Len)
+{
+    while (Len > 0)
+    {
+        if (OtaDecAddLeft > 0)
+        {
+            // literal data
+            size_t Part = min((size_t)OtaDecAddLeft, Len);
+            if (!OtaFlashWrite(Data, Part))
+            {
+                return false;
+            }
+            OtaDecAddLeft -= Part;
+            Data += Part;
+            Len -= Part;
+            continue;
+        }
+        // collect op header
+        OtaDecHdr[OtaDecHdrLen++] = *Data++;
+        Len--;
+        if (OtaDecHdr[0] == OTA_DELTA_OP_COPY && OtaDecHdrLen == 9)
+        {
+            OtaDecHdrLen = 0;
+            if (!OtaDeltaCopy(OtaGetU32(&OtaDecHdr[1]), OtaGetU32(&OtaDecHdr[5])))
+            {
+                LOG_E("OTA decode: invalid delta copy");
+                return false;
+            }
+        }
+        else if (OtaDecHdr[0] == OTA_DELTA_OP_ADD && OtaDecHdrLen == 5)
+        {
+            OtaDecHdrLen = 0;
+            OtaDecAddLeft = OtaGetU32(&OtaDecHdr[1]);
+        }
+        else if (OtaDecHdr[0] != OTA_DELTA_OP_COPY && OtaDecHdr[0] != OTA_DELTA_OP_ADD)
+        {
+            LOG_E("OTA decode: invalid delta op %u", OtaDecHdr[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Handle decoded (inflated) data: detect image or delta and write to flash
+bool OtaPatchWrite(const uint8_t *Data, size_t Len)
+{
+    if (OtaDecFmt == OTA_FMT_IMAGE)
+    {
+        return OtaFlashWrite(Data, Len);
+    }
+    if (OtaDecFmt == OTA_FMT_DELTA)
+    {
+        return OtaDeltaWrite(Data, Len);
+    }
+    // detect format
+    if (OtaDecHdrLen == 0 && Len > 0 && Data[0] == OTA_IMAGE_MAGIC)
+    {
+        OtaDecFmt = OTA_FMT_IMAGE;
+        return OtaFlashWrite(Data, Len);
+    }
+    while (Len > 0 && OtaDecHdrLen < OTA_DELTA_HDR_SIZE)
+    {
+        OtaDecHdr[OtaDecHdrLen++] = *Data++;
+        Len--;
+    }
+    if (OtaDecHdrLen < OTA_DELTA_HDR_SIZE)
+    {
+        return true;
+    }
+    if (memcmp(OtaDecHdr, OTA_DELTA_MAGIC, 4) != 0)
+    {
+        LOG_E("OTA decode: unknown image format");
+        return false;
+    }
+    char BaseVersion[17];
+    memcpy(BaseVersion, &OtaDecHdr[4], 16);
+    BaseVersion[16] = '\0';
+    if (strcmp(BaseVersion, FIRMWARE_VERSION) != 0)
+    {
+        LOG_E("OTA decode: delta requires version %s, running %s", BaseVersion, FIRMWARE_VERSION);
+        return false;
+    }
+    OtaRunning = esp_ota_get_running_partition();
+    OtaDecFmt = OTA_FMT_DELTA;
+    OtaDecHdrLen = 0;
+    LOG_I("OTA decode: applying delta, image size %lu", (unsigned long)OtaGetU32(&OtaDecHdr[20]));
+    return OtaDeltaWrite(Data, Len);
+}
+
+// Inflate zlib data and pass it on to the patch stage
+bool OtaInflate(const uint8_t *Data, size_t Len)
+{
+    while (!OtaDecZlibDone)
+    {
+        size_t InLen = Len;
+        size_t OutLen = TINFL_LZ_DICT_SIZE - OtaDictOfs;
+        tinfl_status Status = tinfl_decompress(OtaInflator, Data, &InLen, OtaDict, OtaDict + OtaDictOfs, &OutLen,
+                                               TINFL_FLAG_PARSE_ZLIB_HEADER | TINFL_FLAG_HAS_MORE_INPUT);
+        Data += InLen;
+        Len -= InLen;
+        if (OutLen > 0)
+        {
+            if (!OtaPatchWrite(OtaDict + OtaDictOfs, OutLen))
+            {
+                return false;
+            }
+            OtaDictOfs = (OtaDictOfs + OutLen) & (TINFL_LZ_DICT_SIZE - 1);
+        }
+        if (Status < TINFL_STATUS_DONE)
+        {
+            LOG_E("OTA decode: inflate failed (%d)", (int)Status);
+            return false;
+        }
+        if (Status == TINFL_STATUS_DONE)
+        {
+            OtaDecZlibDone = true;
+        }
+        else if (Status == TINFL_STATUS_NEEDS_MORE_INPUT && Len == 0)
+        {
+            break;
+        }
+    }
+    return true;
+}
+
+bool OtaDecodeBegin()
+{
+    OtaDecFirstByte = true;
+    OtaDecZlib = false;
+    OtaDecZlibDone = false;
+    OtaDecFmt = OTA_FMT_DETECT;
+    OtaDecHdrLen = 0;
+    OtaDecAddLeft = 0;
+    return Update.begin(UPDATE_SIZE_UNKNOWN);
+}
+
+bool OtaDecodeWrite(const uint8_t *Data, size_t Len)
+{
+    if (Len == 0)
+    {
+        return true;
+    }
+    if (OtaDecFirstByte)
+    {
+        OtaDecFirstByte = false;
+        // zlib header: CM = 8 (deflate), CINFO = 7 (32k window)
+        if (Data[0] == 0x78)
+        {
+            OtaInflator = (tinfl_decompressor *)malloc(sizeof(tinfl_decompressor));
+            OtaDict = (uint8_t *)malloc(TINFL_LZ_DICT_SIZE);
+            if (OtaInflator == NULL || OtaDict == NULL)
+            {
+                LOG_E("OTA decode: not enough memory to inflate");
+                return false;
+            }
+            tinfl_init(OtaInflator);
+            OtaDictOfs = 0;
+            OtaDecZlib = true;
+            LOG_I("OTA decode: inflating compressed image");
+        }
+    }
+    return OtaDecZlib ? OtaInflate(Data, Len) : OtaPatchWrite(Data, Len);
+}
+
+void OtaDecodeFree()
+{
+    free(OtaInflator);
+    free(OtaDict);
+    OtaInflator = NULL;
+    OtaDict = NULL;
+}
+
+bool OtaDecodeEnd()
+{
+    bool Complete = (!OtaDecZlib || OtaDecZlibDone) && OtaDecFmt != OTA_FMT_DETECT && OtaDecHdrLen == 0 && OtaDecAddLeft == 0;
+    OtaDecodeFree();
+    if (!Complete)
+    {
+        LOG_E("OTA decode: incomplete image");
+        Update.abort();
+        return false;
+    }
+    // image size is unknown upfront, Update validates the written image
+    return Update.end(true);
+}
+
+void OtaDecodeAbort()
+{
+    OtaDecodeFree();
+    Update.abort();
+}
+#endif // OTA_PULL
@@ -0,0 +1,230 @@
+/*
+ * ESP32 Template
+ * OTA pull update
+ */
+#include "setup.h"
+#include "ota-pull.h"
+
+#ifdef OTA_PULL
+#include <HTTPClient.h>
+#include "mbedtls/md.h"
+#include "ota-decode.h"
+
+char OtaPullMsg[MQTT_RCV_BUF_SIZE];
+// Version which failed to update and number of attempts (kept during DeepSleep to avoid endless retries)
+RTC_DATA_ATTR char OtaPullFailedVersion[16] = "";
+RTC_DATA_ATTR uint8_t OtaPullFailedCnt = 0;
+
+HTTPClient OtaHttp;
+mbedtls_md_context_t OtaHmacCtx;
+uint8_t OtaHmac[32];
+MqttSubCfg *OtaPullSub = NULL;
+uint32_t OtaPullMsgHandled = 0;
+bool OtaPullRunning = false;
+int OtaPullSize = 0;
+int OtaPullWritten = 0;
+unsigned long OtaPullStartMillis = 0;
+unsigned long OtaPullDataMillis = 0;
+char OtaPullVersion[16];
+
+// Decode hex string to bytes, returns false on invalid input
+bool OtaHexToBytes(const char *Hex, uint8_t *Bytes, size_t Len)
+{
+    if (strlen(Hex) != Len * 2)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < Len; i++)
+    {
+        char Byte[3] = {Hex[i * 2], Hex[i * 2 + 1], '\0'};
+        char *End;
+        Bytes[i] = (uint8_t)strtoul(Byte, &End, 16);
+        if (*End != '\0')
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Stop download and report failure
+void OtaPullFail(const char *Reason)
+{
+    LOG_E("OTA pull: %s", Reason);
+    if (OtaPullRunning)
+    {
+        OtaDecodeAbort();
+        mbedtls_md_free(&OtaHmacCtx);
+        OtaHttp.end();
+        OtaPullRunning = false;
+    }
+    if (strcmp(OtaPullFailedVersion, OtaPullVersion) != 0)
+    {
+        strlcpy(OtaPullFailedVersion, OtaPullVersion, sizeof(OtaPullFailedVersion));
+        OtaPullFailedCnt = 0;
+    }
+    OtaPullFailedCnt++;
+    mqttClt.publish(otaStatus_topic, UPDATEPULLFAIL, true);
+}
+
+// Parse request and start the download
+void OtaPullStart()
+{
+    char Msg[MQTT_RCV_BUF_SIZE];
+    strlcpy(Msg, OtaPullMsg, sizeof(Msg));
+    char *Version = strtok(Msg, "|");
+    char *Hmac = strtok(NULL, "|");
+    char *Url = strtok(NULL, "|");
+    if (Version == NULL || Hmac == NULL || Url == NULL)
+    {
+        LOG_W("OTA pull: ignoring invalid request");
+        return;
+    }
+    strlcpy(OtaPullVersion, Version, sizeof(OtaPullVersion));
+    if (strcmp(OtaPullVersion, FIRMWARE_VERSION) == 0)
+    {
+        LOG_D("OTA pull: firmware %s already running", FIRMWARE_VERSION);
+        return;
+    }
+    if (strcmp(OtaPullVersion, OtaPullFailedVersion) == 0 && OtaPullFailedCnt >= OTA_PULL_MAX_RETRIES)
+    {
+        LOG_D("OTA pull: giving up on version %s", OtaPullVersion);
+        return;
+    }
+    if (!OtaHexToBytes(Hmac, OtaHmac, sizeof(OtaHmac)))
+    {
+        OtaPullFail("invalid HMAC");
+        return;
+    }
+    LOG_I("OTA pull: updating to version %s from %s", OtaPullVersion, Url);
+    mqttClt.publish(otaStatus_topic, UPDATEPULL, true);
+    OtaHttp.setConnectTimeout(OTA_PULL_CONNECT_TIMEOUT);
+    OtaHttp.setTimeout(OTA_PULL_RESPONSE_TIMEOUT);
+    if (!OtaHttp.begin(Url))
+    {
+        OtaPullFail("invalid URL");
+        return;
+    }
+    int HttpCode = OtaHttp.GET();
+    OtaPullSize = OtaHttp.getSize();
+    if (HttpCode != HTTP_CODE_OK || OtaPullSize <= 0)
+    {
+        OtaHttp.end();
+        OtaPullFail("download failed");
+        return;
+    }
+    if (!OtaDecodeBegin())
+    {
+        OtaHttp.end();
+        OtaPullFail("unable to prepare OTA partition");
+        return;
+    }
+    mbedtls_md_init(&OtaHmacCtx);
+    mbedtls_md_setup(&OtaHmacCtx, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 1);
+    mbedtls_md_hmac_starts(&OtaHmacCtx, (const unsigned char *)OTA_PWD, strlen(OTA_PWD));
+    OtaPullWritten = 0;
+    OtaPullStartMillis = millis();
+    OtaPullDataMillis = OtaPullStartMillis;
+    OtaPullRunning = true;
+}
+
+// Verify and activate the completely written image
+void OtaPullFinish()
+{
+    uint8_t Hmac[32];
+    mbedtls_md_hmac_finish(&OtaHmacCtx, Hmac);
+    // compare in constant time
+    uint8_t Diff = 0;
+    for (size_t i = 0; i < sizeof(Hmac); i++)
+    {
+        Diff |= Hmac[i] ^ OtaHmac[i];
+    }
+    if (Diff != 0)
+    {
+        OtaPullFail("HMAC mismatch, image discarded");
+        return;
+    }
+    mbedtls_md_free(&OtaHmacCtx);
+    OtaHttp.end();
+    OtaPullRunning = false;
+    if (!OtaDecodeEnd())
+    {
+        OtaPullFail("unable to activate image");
+        return;
+    }
+    LOG_I("OTA pull: update to version %s successful, restarting", OtaPullVersion);
+    mqttClt.publish(otaStatus_topic, UPDATEOK, true);
+    delay(200);
+    LogFlush();
+    ESP.restart();
+}
+
+void OtaPullHandle()
+{
+    if (!OtaPullRunning)
+    {
+        if (OtaPullSub == NULL)
+        {
+            for (int i = 0; i < SubscribedTopicCnt; i++)
+            {
+                if (MqttSubscriptions[i].stringPtr == OtaPullMsg)
+                {
+                    OtaPullSub = &MqttSubscriptions[i];
+                }
+            }
+        }
+        // MsgRcvd is reset on reconnect, so check for any change
+        if (OtaPullSub->MsgRcvd > 0 && OtaPullSub->MsgRcvd != OtaPullMsgHandled)
+        {
+            OtaPullMsgHandled = OtaPullSub->MsgRcvd;
+            OtaPullStart();
+        }
+        return;
+    }
+    // Keep WiFi up and ESP awake while downloading
+    DelayDeepSleep = true;
+    // Write a limited number of chunks per call to keep the main loop running
+    static uint8_t Chunk[OTA_PULL_CHUNK];
+    WiFiClient *Stream = OtaHttp.getStreamPtr();
+    for (int i = 0; i < OTA_PULL_CHUNKS_PER_LOOP && OtaPullWritten < OtaPullSize; i++)
+    {
+        size_t Avail = Stream->available();
+        if (Avail == 0)
+        {
+            break;
+        }
+        size_t Len = Stream->readBytes(Chunk, min(Avail, sizeof(Chunk)));
+        // HMAC covers the transferred (possibly compressed) data
+        mbedtls_md_hmac_update(&OtaHmacCtx, Chunk, Len);
+        if (!OtaDecodeWrite(Chunk, Len))
+        {
+            OtaPullFail("image decoding failed");
+            return;
+        }
+        OtaPullWritten += Len;
+        OtaPullDataMillis = millis();
+    }
+    if (OtaPullWritten >= OtaPullSize)
+    {
+        OtaPullFinish();
+    }
+    else if (millis() - OtaPullDataMillis > OTA_PULL_STALL_TIMEOUT)
+    {
+        OtaPullFail("download stalled");
+    }
+    else if (millis() - OtaPullStartMillis > OTA_PULL_MAX_DURATION)
+    {
+        OtaPullFail("download timeout");
+    }
+}
+
+bool OtaPullActive()
+{
+    return OtaPullRunning;
+}
+#else
+bool OtaPullActive()
+{
+    return false;
+}
+#endif // OTA_PULL
@@ -0,0 +1,119 @@
+/*
+ * ESP32 Template
+ * RTC slow clock drift learning
+ */
+#include "setup.h"
+#include "rtc-drift.h"
+#include <math.h>
+
+#ifdef RTC_DRIFT_LEARNING
+RTC_DATA_ATTR RtcDriftState Drift = {
+    .Theta = {CLK_CORR_FACTOR, 0.0f},
+    .P = {{DRIFT_P_INIT, 0.0f}, {0.0f, DRIFT_P_INIT}},
+    .Samples = 0,
+    .SamplePending = false,
+    .SleepStart = 0,
+    .SleepCmd = 0,
+    .SleepFactor = CLK_CORR_FACTOR,
+    .Residual = DRIFT_MAX_DEVIATION};
+
+// Factor written to the RTC calibration register at boot and temperature at boot
+float DriftAppliedFactor = 1.0f;
+float DriftBootTemp = DRIFT_TEMP_REF;
+
+// Estimated correction factor for the given temperature
+float DriftEstimate(float Temp)
+{
+    float Factor = Drift.Theta[0] + Drift.Theta[1] * (Temp - DRIFT_TEMP_REF);
+    return constrain(Factor, DRIFT_FACTOR_MIN, DRIFT_FACTOR_MAX);
+}
+
+float DriftBootFactor()
+{
+    // Chip temperature right after wakeup is closest to the temperature during sleep
+    DriftBootTemp = temperatureRead();
+#ifndef ESP32C6
+    DriftAppliedFactor = DriftEstimate(DriftBootTemp);
+#endif
+    return DriftAppliedFactor;
+}
+
+uint64_t DriftPrepareSleep(uint32_t Seconds)
+{
+    // RTC calibration has been set with the factor at boot, compensate if the estimate changed in the meantime
+    float Cmd = (float)Seconds * DriftAppliedFactor / DriftEstimate(DriftBootTemp);
+    Drift.SleepCmd = (uint32_t)(Cmd + 0.5f);
+    Drift.SleepFactor = DriftAppliedFactor;
+    Drift.SleepStart = time(NULL);
+    // only learn from long sleeps with valid time
+    Drift.SamplePending = (NTPSyncCounter > 0 && Seconds >= DRIFT_MIN_SLEEP);
+    return (uint64_t)Drift.SleepCmd * 1000000ULL;
+}
+
+void DriftLearn()
+{
+    if (!Drift.SamplePending || NTPSyncCounter == 0)
+    {
+        return;
+    }
+    Drift.SamplePending = false;
+    if (esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_TIMER)
+    {
+        // woke up early (e.g. button), sample not usable
+        return;
+    }
+    // actual sleep duration = NTP time - sleep start - time since wakeup
+    struct timeval Now;
+    gettimeofday(&Now, NULL);
+    float Actual = (float)(Now.tv_sec - Drift.SleepStart) + (float)Now.tv_usec / 1000000.0f - (float)millis() / 1000.0f;
+    // correction factor which would have been right for this sleep
+    float Sample = Drift.SleepFactor * Actual / (float)Drift.SleepCmd;
+    float Predicted = DriftEstimate(DriftBootTemp);
+    if (fabsf(Sample / Predicted - 1.0f) > DRIFT_MAX_DEVIATION)
+    {
+        LOG_W("RTC drift: discarding implausible sample %.6f", Sample);
+        return;
+    }
+    Drift.Residual = max(fabsf(Sample / Predicted - 1.0f), Drift.Residual * DRIFT_FORGET);
+    // Recursive least squares update with forgetting factor
+    float x[2] = {1.0f, DriftBootTemp - DRIFT_TEMP_REF};
+    float Px[2] = {Drift.P[0][0] * x[0] + Drift.P[0][1] * x[1],
+                   Drift.P[1][0] * x[0] + Drift.P[1][1] * x[1]};
+    float Denom = DRIFT_FORGET + x[0] * Px[0] + x[1] * Px[1];
+    float K[2] = {Px[0] / Denom, Px[1] / Denom};
+    float Err = Sample - (Drift.Theta[0] + Drift.Theta[1] * x[1]);
+    Drift.Theta[0] += K[0] * Err;
+    Drift.Theta[1] += K[1] * Err;
+    for (int i = 0; i < 2; i++)
+    {
+        for (int j = 0; j < 2; j++)
+        {
+            Drift.P[i][j] = (Drift.P[i][j] - K[i] * Px[j]) / DRIFT_FORGET;
+        }
+    }
+    // avoid covariance windup if the temperature hardly changes (forgetting factor inflates P)
+    float MaxVar = (Drift.P[0][0] > Drift.P[1][1]) ? Drift.P[0][0] : Drift.P[1][1];
+    if (MaxVar > DRIFT_P_INIT)
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            for (int j = 0; j < 2; j++)
+            {
+                Drift.P[i][j] *= DRIFT_P_INIT / MaxVar;
+            }
+        }
+    }
+    Drift.Samples++;
+    LOG_I("RTC drift: sample %.6f at %.1f°C, new estimate %.6f", Sample, DriftBootTemp, DriftEstimate(DriftBootTemp));
+}
+
+float DriftErrorBound()
+{
+    if (Drift.Samples < DRIFT_MIN_SAMPLES)
+    {
+        return DRIFT_MAX_DEVIATION;
+    }
+    // safety margin for temperature changes during sleep
+    return max(2.0f * Drift.Residual, DRIFT_BOUND_MIN);
+}
+#endif // RTC_DRIFT_LEARNING
@@ -8,6 +8,9 @@
 bool JustBooted = true;      // Helper to let you know you're running the first iteration of the main loop()
 bool DelayDeepSleep = false; // skips DeepSleep execution in main loop when true
 uint32_t UptimeSeconds = 0;  // Uptime counter
+#ifdef DIAG_RING
+unsigned long WiFiStartMillis = 0; // millis() when WiFi was started
+#endif
 // Define WiFi Variables
 const char *ssid = WIFI_SSID;
 const char *password = WIFI_PSK;
@@ -20,7 +23,7 @@ const int NetFailAction = NET_OUTAGE;
 unsigned long NetRecoveryMillis = 0;
 
 // Define MQTT and OTA-update Variables
-char message_buff[MQTT_MAX_MSG_SIZE];
+char message_buff[MQTT_RCV_BUF_SIZE];
 bool OTAupdate = false;
 bool SentUpdateRequested = false;
 bool OtaInProgress = false;
@@ -34,7 +37,11 @@ float VCC = 3.333;
 WiFiClient WiFiClt;
 
 // Setup PubSub Client instance
+#ifdef FLEET_MODE
+FleetMqttClient mqttClt(MQTT_BROKER, 1883, MqttCallback, WiFiClt);
+#else
 PubSubClient mqttClt(MQTT_BROKER, 1883, MqttCallback, WiFiClt);
+#endif
 
 #ifdef NTP_CLT
 // Define vars for NTP client
@@ -44,8 +51,6 @@ const char *NTPServer2 = NTPSRV_2;
 #endif
 const char *time_zone = TIMEZONE;
 unsigned int NTPSyncCounter = 0;
-struct tm TimeInfo;
-time_t EpochTime;
 #endif
 // Vars for sleep-until function
 #ifdef SLEEP_UNTIL
@@ -72,7 +77,12 @@ void hardware_setup()
 #else
     esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_SLOW_MEM, ESP_PD_OPTION_OFF);
 #endif
+#ifdef WAKE_STUB
+    // wake stub is located in RTC fast memory
+    esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_FAST_MEM, ESP_PD_OPTION_ON);
+#else
     esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_FAST_MEM, ESP_PD_OPTION_OFF);
+#endif
     esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_PERIPH, ESP_PD_OPTION_OFF);
 #endif // ESP32-C6
 #ifdef SLEEP_RTC_CLK_8M
@@ -92,7 +102,11 @@ void hardware_setup()
 #ifndef ESP32C6 // TODO for ESP32-C6
     // Measure clock period of RTC slow clock, add correction and save to RTC register
     uint32_t rtcClkPeriod = (uint32_t)(0.5 + rtc_clk_cal(RTC_CAL_RTC_MUX, 1024));
+#ifdef RTC_DRIFT_LEARNING
+    uint32_t rtcClkPeriodCalib = rtcClkPeriod * DriftBootFactor();
+#else
     uint32_t rtcClkPeriodCalib = rtcClkPeriod * CLK_CORR_FACTOR;
+#endif
     REG_WRITE(RTC_CNTL_STORE1_REG, rtcClkPeriodCalib);
     delay(10);
 #endif
@@ -108,23 +122,37 @@ void wifi_setup()
     WiFi.setHostname(WIFI_DHCPNAME);
 
     // Connect to WiFi network
-    DEBUG_PRINTLN();
-    DEBUG_PRINTLN("Connecting to " + String(ssid));
+    LOG_I("Connecting to %s", ssid);
+#ifdef DIAG_RING
+    WiFiStartMillis = millis();
+#endif
+#ifdef ENERGY_STATS
+    unsigned long AssocStartMillis = millis();
+#endif
     WiFi.mode(WIFI_MODE_STA);
+#ifdef CONNECTED_IDLE
+    // Listen interval is negotiated at association, so it has to be configured before connecting
+    wifi_config_t WifiCfg = {};
+    strlcpy((char *)WifiCfg.sta.ssid, ssid, sizeof(WifiCfg.sta.ssid));
+    strlcpy((char *)WifiCfg.sta.password, password, sizeof(WifiCfg.sta.password));
+    WifiCfg.sta.listen_interval = WIFI_LISTEN_INTERVAL;
+    esp_wifi_set_config(WIFI_IF_STA, &WifiCfg);
+    WiFi.begin();
+#else
     WiFi.begin(ssid, password);
+#endif
     unsigned long end_connect = millis() + WIFI_CONNECT_TIMEOUT;
     while (!WiFi.isConnected())
     {
         if (millis() >= end_connect)
         {
-            DEBUG_PRINTLN("");
-            DEBUG_PRINTLN("Failed to connect to " + String(ssid));
+            LOG_E("Failed to connect to %s", ssid);
 #ifdef ONBOARD_LED
             ToggleLed(LED, 1000, 4);
 #endif
 #ifdef E32_DEEP_SLEEP
-            DEBUG_PRINTLN("Good night for " + String(DS_DURATION_MIN) + " minutes.");
-            esp_deep_sleep((uint64_t)DS_DURATION_MIN * 60000000);
+            LOG_I("Good night for %d minutes.", DS_DURATION_MIN);
+            EnterDeepSleep(DS_DURATION_MIN * 60, -1);
 #else
             if (NetFailAction == 0)
             {
@@ -132,21 +160,21 @@ void wifi_setup()
             }
             else
             {
-                DEBUG_PRINTLN("Unable to connect to WiFi, continuing");
+                LOG_W("Unable to connect to WiFi, continuing");
                 NetState = NET_FAIL;
             }
 #endif
         }
         delay(500);
-        DEBUG_PRINT(".:W!:.");
     }
-    DEBUG_PRINTLN("");
-    DEBUG_PRINTLN("WiFi connected");
-    DEBUG_PRINT("Device IP Address: ");
-    DEBUG_PRINTLN(WiFi.localIP());
-    DEBUG_PRINT("DHCP Hostname: ");
-    DEBUG_PRINTLN(WIFI_DHCPNAME);
+    uint32_t LocalIP = WiFi.localIP();
+    LOG_I("WiFi connected, Device IP Address: %u.%u.%u.%u, DHCP Hostname: %s", (unsigned)(LocalIP & 0xFF), (unsigned)((LocalIP >> 8) & 0xFF),
+          (unsigned)((LocalIP >> 16) & 0xFF), (unsigned)(LocalIP >> 24), WIFI_DHCPNAME);
     NetState = NET_UP;
+    DIAG_ADD(DIAG_PHASE, DIAG_PH_WIFI, millis() - WiFiStartMillis);
+#ifdef ENERGY_STATS
+    EnergyAdd(EN_ASSOC, millis() - AssocStartMillis);
+#endif
 #ifdef ONBOARD_LED
     // WiFi connected - blink once
     ToggleLed(LED, 200, 2);
@@ -184,12 +212,12 @@ void ota_setup()
         int percentComplete = (progress / (total / 100));
         if (percentComplete == 100)
         {
-            DEBUG_PRINTLN("Upload complete.");
+            LOG_I("Upload complete.");
             delay(500);
         } });
     ArduinoOTA.onError([](ota_error_t error)
                        {
-        DEBUG_PRINTLN("Error: " + String(error));
+        LOG_E("OTA Error: %d", (int)error);
         delay(500); });
     ArduinoOTA.begin();
 }
@@ -206,9 +234,7 @@ void ntp_setup()
 #else
     configTzTime(time_zone, NTPServer1);
 #endif
-    // Run first sync
-    getLocalTime(&TimeInfo, 200);
-    time(&EpochTime);
+    // sync runs in the background, see NTP_Synced_Callback
 }
 #endif // NTP_CLT
 
@@ -222,9 +248,20 @@ void setup()
 #ifdef SERIAL_OUT
     Serial.begin(BAUD_RATE);
 #endif
-    DEBUG_PRINTLN();
-    DEBUG_PRINTLN(FIRMWARE_NAME);
-    DEBUG_PRINTLN(FIRMWARE_VERSION);
+    LogSetup();
+#ifdef FLEET_MODE
+    // Load device specific configuration (client name, topic tree, ..)
+    FleetConfigLoad();
+#endif
+#ifdef OTA_PULL
+    // OTA pull requests exceed the default PubSubClient buffer (incl. topic and header)
+    mqttClt.setBufferSize(MQTT_RCV_BUF_SIZE + 64);
+#endif
+#ifdef CONNECTED_IDLE
+    // Radio sleeps most of the time, avoid waking it up for pings
+    mqttClt.setKeepAlive(CI_MQTT_KEEPALIVE);
+#endif
+    LOG_I("%s %s", FIRMWARE_NAME, FIRMWARE_VERSION);
 #ifdef ONBOARD_LED
     pinMode(LED, OUTPUT);
     digitalWrite(LED, LEDOFF);
@@ -232,6 +269,25 @@ void setup()
 
     // hardware specific setup
     hardware_setup();
+#ifdef NTP_CLT
+    // Check if RTC time is still valid after DeepSleep
+    TimeTrustBoot();
+    ClockUpdate();
+#endif
+    DIAG_ADD(DIAG_BOOT, esp_reset_reason(), esp_sleep_get_wakeup_cause());
+#ifdef WAKE_STUB
+    WakeStubBoot();
+#endif
+#ifdef ULP_MONITOR
+    UlpMonitorBoot();
+#endif
+#ifdef ENERGY_STATS
+    EnergyBoot();
+#endif
+
+    // Setup user specific stuff
+    // ATTN: runs before WiFi is up to allow restoring local data as fast as possible
+    user_setup();
 
 #ifndef BOOT_WIFI_OFF
     // Startup WiFi
@@ -244,9 +300,6 @@ void setup()
 #endif
 #endif // NDEF BOOT_WIFI_OFF
 
-    // Setup user specific stuff
-    user_setup();
-
 #ifdef ONBOARD_LED
     // Signal setup finished
     ToggleLed(LED, 200, 6);
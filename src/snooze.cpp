@@ -0,0 +1,57 @@
+/*
+ * ESP32 Rememberall
+ * Snooze (skip reminder) functions
+ */
+#include "snooze.h"
+#include "generic-config.h"
+
+//
+// Snooze policy:
+// - cosy reminder period: sleep until the aggressive reminder starts, but max. SNZ_COSY_DURATION
+// - aggressive reminder period: sleep for SNZ_AGGRO_DURATION
+// - always wake up SNZ_DEADLINE_LEAD seconds before the deadline (or at the deadline if that's already too close)
+// - never sleep less than SNZ_MIN_DURATION, unless the deadline is closer
+//
+uint32_t SnoozeDuration(eventInfoStruct *EventData, time_t Now, bool Active)
+{
+    if (!Active || EventData->Deadline <= Now)
+    {
+        return BUT_SLEEP_DURATION;
+    }
+    time_t WakeAt;
+    if (Now < EventData->AgressiveReminder)
+    {
+        WakeAt = Now + SNZ_COSY_DURATION;
+        if (WakeAt > EventData->AgressiveReminder)
+        {
+            WakeAt = EventData->AgressiveReminder;
+        }
+    }
+    else
+    {
+        WakeAt = Now + SNZ_AGGRO_DURATION;
+    }
+    // Clamp to deadline
+    if (WakeAt > EventData->Deadline - SNZ_DEADLINE_LEAD)
+    {
+        WakeAt = EventData->Deadline - SNZ_DEADLINE_LEAD;
+        if (WakeAt - Now < SNZ_MIN_DURATION)
+        {
+            // too close to the deadline for another reminder, wake up when the event starts (clears the display)
+            WakeAt = EventData->Deadline;
+        }
+    }
+    // Minimum sleep, but never beyond the deadline (Deadline > Now, see above)
+    if (WakeAt - Now < SNZ_MIN_DURATION)
+    {
+        WakeAt = min(Now + (time_t)SNZ_MIN_DURATION, EventData->Deadline);
+    }
+    return (uint32_t)(WakeAt - Now);
+}
+
+void SnoozeSleep(uint32_t Seconds)
+{
+    LOG_I("Snoozing for %lu seconds.", (unsigned long)Seconds);
+    // a button press will also wake up the ESP
+    EnterDeepSleep(Seconds, BUTTON_GPIO);
+}
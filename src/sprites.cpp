@@ -0,0 +1,141 @@
+/*
+ * ESP32 Rememberall
+ * Event icons (sprites) compiled into flash
+ */
+#include "sprites.h"
+
+//
+// 32x32 pixel icons, 2 planes (black / red)
+// Icons are drawn left of the event text, see DisplayText in user_setup_loop.cpp
+//
+static const uint8_t IconTrashBlack[] PROGMEM = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x0F, 0xF0, 0x00, 0x00, 0x0F, 0xF0, 0x00,
+    0x0F, 0xFF, 0xFF, 0xF0, 0x0F, 0xFF, 0xFF, 0xF0,
+    0x0F, 0xFF, 0xFF, 0xF0, 0x00, 0x00, 0x00, 0x00,
+    0x03, 0xFF, 0xFF, 0xC0, 0x03, 0xFF, 0xFF, 0xC0,
+    0x03, 0x00, 0x00, 0xC0, 0x03, 0x18, 0x18, 0xC0,
+    0x03, 0x18, 0x18, 0xC0, 0x03, 0x19, 0x98, 0xC0,
+    0x03, 0x19, 0x98, 0xC0, 0x03, 0x19, 0x98, 0xC0,
+    0x03, 0x19, 0x98, 0xC0, 0x03, 0x19, 0x98, 0xC0,
+    0x03, 0x19, 0x98, 0xC0, 0x01, 0x99, 0x99, 0x80,
+    0x01, 0x99, 0x99, 0x80, 0x01, 0x99, 0x99, 0x80,
+    0x01, 0x99, 0x99, 0x80, 0x01, 0x99, 0x99, 0x80,
+    0x01, 0x99, 0x99, 0x80, 0x01, 0x98, 0x19, 0x80,
+    0x01, 0x98, 0x19, 0x80, 0x01, 0x80, 0x01, 0x80,
+    0x01, 0xFF, 0xFF, 0x80, 0x01, 0xFF, 0xFF, 0x80,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+static const uint8_t IconSportBlack[] PROGMEM = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0xC0, 0x00,
+    0x00, 0x3F, 0xFC, 0x00, 0x00, 0xFF, 0xFF, 0x00,
+    0x01, 0xF0, 0x0F, 0x80, 0x03, 0xE0, 0x07, 0xC0,
+    0x07, 0x70, 0x0E, 0xE0, 0x0F, 0xB0, 0x0C, 0x70,
+    0x1D, 0xF8, 0x1C, 0x38, 0x1C, 0xF8, 0x18, 0x38,
+    0x38, 0x78, 0x18, 0x1C, 0x38, 0x38, 0x18, 0x1C,
+    0x30, 0x1C, 0x30, 0x0C, 0x30, 0x0E, 0x30, 0x0C,
+    0x70, 0x0F, 0x30, 0x0E, 0x70, 0x0F, 0xB0, 0x0E,
+    0x70, 0x0D, 0xF0, 0x0E, 0x70, 0x0C, 0xF0, 0x0E,
+    0x30, 0x0C, 0x70, 0x0C, 0x30, 0x0C, 0x38, 0x0C,
+    0x38, 0x18, 0x1C, 0x1C, 0x38, 0x18, 0x1E, 0x1C,
+    0x1C, 0x18, 0x1F, 0x38, 0x1C, 0x38, 0x1F, 0xB8,
+    0x0E, 0x30, 0x0D, 0xF0, 0x07, 0x70, 0x0E, 0xE0,
+    0x03, 0xE0, 0x07, 0xC0, 0x01, 0xF0, 0x0F, 0x80,
+    0x00, 0xFF, 0xFF, 0x00, 0x00, 0x3F, 0xFC, 0x00,
+    0x00, 0x03, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+static const uint8_t IconCakeBlack[] PROGMEM = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x61, 0x86, 0x00, 0x00, 0x61, 0x86, 0x00,
+    0x00, 0x61, 0x86, 0x00, 0x00, 0x61, 0x86, 0x00,
+    0x00, 0x61, 0x86, 0x00, 0x00, 0x61, 0x86, 0x00,
+    0x1F, 0xFF, 0xFF, 0xF8, 0x1F, 0xFF, 0xFF, 0xF8,
+    0x18, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x18,
+    0x18, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x18,
+    0x18, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x18,
+    0x18, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x18,
+    0x18, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x18,
+    0x18, 0x00, 0x00, 0x18, 0x18, 0x00, 0x00, 0x18,
+    0x1F, 0xFF, 0xFF, 0xF8, 0x1F, 0xFF, 0xFF, 0xF8,
+    0x7F, 0xFF, 0xFF, 0xFE, 0x7F, 0xFF, 0xFF, 0xFE
+};
+
+static const uint8_t IconCakeRed[] PROGMEM = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x82, 0x00,
+    0x00, 0x41, 0x04, 0x00, 0x00, 0x61, 0x86, 0x00,
+    0x00, 0x61, 0x86, 0x00, 0x00, 0x61, 0x86, 0x00,
+    0x00, 0x61, 0x86, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0xE0, 0x00,
+    0x04, 0x0F, 0xF0, 0x60, 0x07, 0xF8, 0x1F, 0xE0,
+    0x03, 0xF0, 0x0F, 0x80, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+static const uint8_t IconHealthBlack[] PROGMEM = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x3F, 0xFC, 0x00, 0x00, 0x3F, 0xFC, 0x00,
+    0x00, 0x30, 0x0C, 0x00, 0x00, 0x30, 0x0C, 0x00,
+    0x00, 0x30, 0x0C, 0x00, 0x00, 0x30, 0x0C, 0x00,
+    0x00, 0x30, 0x0C, 0x00, 0x00, 0x30, 0x0C, 0x00,
+    0x3F, 0xF0, 0x0F, 0xFC, 0x3F, 0xF0, 0x0F, 0xFC,
+    0x30, 0x00, 0x00, 0x0C, 0x30, 0x00, 0x00, 0x0C,
+    0x30, 0x00, 0x00, 0x0C, 0x30, 0x00, 0x00, 0x0C,
+    0x30, 0x00, 0x00, 0x0C, 0x30, 0x00, 0x00, 0x0C,
+    0x30, 0x00, 0x00, 0x0C, 0x30, 0x00, 0x00, 0x0C,
+    0x3F, 0xF0, 0x0F, 0xFC, 0x3F, 0xF0, 0x0F, 0xFC,
+    0x00, 0x30, 0x0C, 0x00, 0x00, 0x30, 0x0C, 0x00,
+    0x00, 0x30, 0x0C, 0x00, 0x00, 0x30, 0x0C, 0x00,
+    0x00, 0x30, 0x0C, 0x00, 0x00, 0x30, 0x0C, 0x00,
+    0x00, 0x3F, 0xFC, 0x00, 0x00, 0x3F, 0xFC, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+static const uint8_t IconHealthRed[] PROGMEM = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x0F, 0xF0, 0x00, 0x00, 0x0F, 0xF0, 0x00,
+    0x00, 0x0F, 0xF0, 0x00, 0x00, 0x0F, 0xF0, 0x00,
+    0x00, 0x0F, 0xF0, 0x00, 0x00, 0x0F, 0xF0, 0x00,
+    0x00, 0x0F, 0xF0, 0x00, 0x00, 0x0F, 0xF0, 0x00,
+    0x0F, 0xFF, 0xFF, 0xF0, 0x0F, 0xFF, 0xFF, 0xF0,
+    0x0F, 0xFF, 0xFF, 0xF0, 0x0F, 0xFF, 0xFF, 0xF0,
+    0x0F, 0xFF, 0xFF, 0xF0, 0x0F, 0xFF, 0xFF, 0xF0,
+    0x0F, 0xFF, 0xFF, 0xF0, 0x0F, 0xFF, 0xFF, 0xF0,
+    0x00, 0x0F, 0xF0, 0x00, 0x00, 0x0F, 0xF0, 0x00,
+    0x00, 0x0F, 0xF0, 0x00, 0x00, 0x0F, 0xF0, 0x00,
+    0x00, 0x0F, 0xF0, 0x00, 0x00, 0x0F, 0xF0, 0x00,
+    0x00, 0x0F, 0xF0, 0x00, 0x00, 0x0F, 0xF0, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+const int SpriteCnt = 5;
+
+const SpriteCfg Sprites[SpriteCnt] = {
+    {.Width = 0, .Height = 0, .BlackPlane = NULL, .RedPlane = NULL}, // ICON_NONE
+    {.Width = 32, .Height = 32, .BlackPlane = IconTrashBlack, .RedPlane = NULL},
+    {.Width = 32, .Height = 32, .BlackPlane = IconSportBlack, .RedPlane = NULL},
+    {.Width = 32, .Height = 32, .BlackPlane = IconCakeBlack, .RedPlane = IconCakeRed},
+    {.Width = 32, .Height = 32, .BlackPlane = IconHealthBlack, .RedPlane = IconHealthRed}};
+
+const SpriteCfg *GetSprite(uint8_t IconId)
+{
+    if (IconId == ICON_NONE || IconId >= SpriteCnt)
+    {
+        return NULL;
+    }
+    return &Sprites[IconId];
+}
@@ -0,0 +1,62 @@
+/*
+ * ESP32 Template
+ * System clock service
+ */
+#include "setup.h"
+#include "sysclock.h"
+
+#ifdef NTP_CLT
+// Cached time
+time_t ClkEpoch = 0;
+struct tm ClkTimeInfo;
+volatile bool ClkValid = false;
+// Last plausible system time and esp_timer value at that time (monotonic fallback)
+time_t ClkRefEpoch = 0;
+int64_t ClkRefTimer_us = 0;
+
+void ClockUpdate()
+{
+    int64_t Timer_us = esp_timer_get_time();
+    time_t SysEpoch = time(NULL);
+    if (SysEpoch >= CLOCK_MIN_EPOCH && SysEpoch <= CLOCK_MAX_EPOCH)
+    {
+        ClkRefEpoch = SysEpoch;
+        ClkRefTimer_us = Timer_us;
+    }
+    else if (ClkRefEpoch > 0)
+    {
+        // System time became implausible, continue from last plausible value
+        SysEpoch = ClkRefEpoch + (time_t)((Timer_us - ClkRefTimer_us) / 1000000LL);
+    }
+    else if (ClkValid)
+    {
+        LOG_W("Implausible system time, invalidating local time until next NTP sync");
+        ClkValid = false;
+    }
+    if (SysEpoch != ClkEpoch)
+    {
+        ClkEpoch = SysEpoch;
+        localtime_r(&ClkEpoch, &ClkTimeInfo);
+    }
+}
+
+time_t ClockNow()
+{
+    return ClkEpoch;
+}
+
+const struct tm *ClockTimeInfo()
+{
+    return &ClkTimeInfo;
+}
+
+bool ClockValid()
+{
+    return ClkValid;
+}
+
+void ClockSetValid(bool Valid)
+{
+    ClkValid = Valid;
+}
+#endif // NTP_CLT
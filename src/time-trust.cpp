@@ -0,0 +1,90 @@
+/*
+ * ESP32 Template
+ * RTC time validity
+ */
+#include "setup.h"
+#include "time-trust.h"
+
+#ifdef NTP_CLT
+#ifdef RTC_TIME_TRUST
+#define TRUST_MAGIC 0x54525354
+// Epoch of the last NTP sync (0 = never synced) and check value
+// RTC_NOINIT: RTC timer and system time also survive software, panic, watchdog and brownout resets
+RTC_NOINIT_ATTR time_t TrustLastSync;
+RTC_NOINIT_ATTR uint32_t TrustCheck;
+#endif
+
+void TimeTrustBoot()
+{
+#ifdef RTC_TIME_TRUST
+    // RTC memory and system time are lost on power-on (and possibly on external resets)
+    if (esp_reset_reason() == ESP_RST_POWERON || TrustCheck != (TRUST_MAGIC ^ (uint32_t)TrustLastSync))
+    {
+        TrustLastSync = 0;
+        TrustCheck = TRUST_MAGIC;
+        return;
+    }
+    if (TrustLastSync == 0)
+    {
+        return;
+    }
+    float Error = TimeErrorEstimate();
+    if (Error < TRUST_MAX_ERROR)
+    {
+        ClockSetValid(true);
+        LOG_I("RTC time trusted, estimated error %.1f s", Error);
+    }
+    else
+    {
+        LOG_I("RTC time not trusted, estimated error %.1f s - waiting for NTP sync", Error);
+    }
+#endif
+}
+
+void TimeTrustSynced(time_t SyncEpoch)
+{
+#ifdef RTC_TIME_TRUST
+    TrustLastSync = SyncEpoch;
+    TrustCheck = TRUST_MAGIC ^ (uint32_t)SyncEpoch;
+#endif
+    ClockSetValid(true);
+}
+
+float TimeErrorEstimate()
+{
+#ifdef RTC_TIME_TRUST
+    if (TrustLastSync == 0)
+    {
+        return 1e9f;
+    }
+    float Bound = TRUST_DRIFT_BOUND;
+#ifdef RTC_DRIFT_LEARNING
+    // learned drift is usually much more accurate than the worst case assumption
+    Bound = min(Bound, DriftErrorBound());
+#endif
+    time_t Elapsed = time(NULL) - TrustLastSync;
+    if (Elapsed < 0)
+    {
+        // RTC time behind last sync (e.g. RTC timer reset), can't be trusted
+        return 1e9f;
+    }
+    return (float)Elapsed * Bound + TRUST_SYNC_ERROR;
+#else
+    return (NTPSyncCounter > 0) ? 0.0f : 1e9f;
+#endif
+}
+
+bool TimeResyncDue()
+{
+    if (NTPSyncCounter > 0)
+    {
+        // synced in this session
+        return false;
+    }
+#ifdef RTC_TIME_TRUST
+    return (TimeErrorEstimate() > TRUST_RESYNC_ERROR);
+#else
+    return true;
+#endif
+}
+#endif // NTP_CLT
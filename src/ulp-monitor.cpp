@@ -0,0 +1,206 @@
+/*
+ * ESP32 Rememberall
+ * ULP battery and button monitor
+ */
+#include "setup.h"
+#include "ulp-monitor.h"
+
+#ifdef ULP_MONITOR
+#include "driver/adc.h"
+#include "driver/rtc_io.h"
+#include "soc/rtc_cntl_reg.h"
+#include "soc/rtc_io_reg.h"
+#if CONFIG_IDF_TARGET_ESP32S2
+#include "esp32s2/ulp.h"
+#else
+#include "esp32/ulp.h"
+#endif
+
+// ULP data (32 bit words in RTC slow memory following the program; the ULP only uses the lower 16 bits)
+#define D_MAGIC 0   // ULP_MAGIC if the data has been initialized
+#define D_BTN_CNT 1 // consecutive low button samples
+#define D_TICKS 2   // ULP periods since the last VBAT sample
+#define D_TOTAL 3   // VBAT samples taken (16 bit, wraps)
+#define D_REASON 4  // ULP_WAKE_x
+#define D_RING 5    // VBAT samples (raw ADC values)
+#define ULP_DATA_WORDS (D_RING + ULP_VBAT_RING)
+#define ULP_MAGIC 0x55AA
+#define ULP_DATA(Offset) RTC_SLOW_MEM[ULP_PROG_WORDS + (Offset)]
+
+#if defined CONFIG_ULP_COPROC_RESERVE_MEM && (ULP_PROG_WORDS + ULP_DATA_WORDS) * 4 > CONFIG_ULP_COPROC_RESERVE_MEM
+#error "ULP program and data exceed CONFIG_ULP_COPROC_RESERVE_MEM, reduce ULP_VBAT_RING!"
+#endif
+#if ULP_VBAT_INTERVAL * 1000 / ULP_PERIOD_MS > 0xFFFF
+#error "ULP_VBAT_INTERVAL too long for ULP_PERIOD_MS (16 bit tick counter)"
+#endif
+
+// Labels of the ULP program
+#define L_BTN_UP 0
+#define L_VBAT 1
+#define L_WAKE 2
+#define L_DONE 3
+
+RTC_DATA_ATTR uint16_t UlpReadTotal = 0; // value of D_TOTAL when the samples have been published the last time
+
+// VBAT samples collected at boot
+static uint16_t UlpHistMv[ULP_VBAT_RING];
+static int UlpHistCnt = 0;
+static uint16_t UlpHistTotal = 0;  // D_TOTAL at boot
+static uint32_t UlpHistAgeMs = 0;  // age of the newest sample at boot
+static bool UlpHistPublished = false;
+
+// Convert raw ULP ADC value to mV
+static uint16_t UlpRawToMv(uint32_t Raw)
+{
+    return (uint16_t)(1000.0f * VDIV * VFULL_SCALE * (float)Raw / ULP_ADC_MAXVAL);
+}
+
+int UlpMonitorBoot()
+{
+    // Stop the ULP, the ADC is used by the main CPU
+    CLEAR_PERI_REG_MASK(RTC_CNTL_ULP_CP_TIMER_REG, RTC_CNTL_ULP_CP_SLP_TIMER_EN);
+    if ((ULP_DATA(D_MAGIC) & 0xFFFF) != ULP_MAGIC)
+    {
+        // first boot after power loss
+        for (int i = 0; i < ULP_DATA_WORDS; i++)
+        {
+            ULP_DATA(i) = 0;
+        }
+        ULP_DATA(D_MAGIC) = ULP_MAGIC;
+        UlpReadTotal = 0;
+        return ULP_WAKE_NONE;
+    }
+    // Button pin is used by OneButtonTiny while awake
+    rtc_gpio_hold_dis((gpio_num_t)BUTTON_GPIO);
+    rtc_gpio_deinit((gpio_num_t)BUTTON_GPIO);
+
+    // Collect samples not published yet (oldest first)
+    UlpHistTotal = (uint16_t)ULP_DATA(D_TOTAL);
+    uint16_t Pending = UlpHistTotal - UlpReadTotal;
+    UlpHistCnt = (Pending > ULP_VBAT_RING) ? ULP_VBAT_RING : Pending;
+    for (int i = 0; i < UlpHistCnt; i++)
+    {
+        uint16_t Idx = (UlpHistTotal - UlpHistCnt + i) & (ULP_VBAT_RING - 1);
+        UlpHistMv[i] = UlpRawToMv(ULP_DATA(D_RING + Idx) & 0xFFFF);
+    }
+    UlpHistAgeMs = (ULP_DATA(D_TICKS) & 0xFFFF) * ULP_PERIOD_MS;
+
+    int Reason = ULP_WAKE_NONE;
+    if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_ULP)
+    {
+        Reason = ULP_DATA(D_REASON) & 0xFFFF;
+        LOG_I("ULP wakeup: %s", (Reason == ULP_WAKE_BUTTON) ? "button" : "low battery");
+    }
+    ULP_DATA(D_REASON) = ULP_WAKE_NONE;
+    ULP_DATA(D_BTN_CNT) = 0;
+    if (UlpHistCnt > 0)
+    {
+        LOG_D("ULP: %d VBAT samples, last %u mV", UlpHistCnt, (unsigned)UlpHistMv[UlpHistCnt - 1]);
+    }
+    return Reason;
+}
+
+void UlpMonitorArm()
+{
+    int AdcChannel = digitalPinToAnalogChannel(VBAT_ADC_PIN);
+    if (AdcChannel < 0 || AdcChannel >= ADC1_CHANNEL_MAX)
+    {
+        LOG_E("ULP: VBAT_ADC_PIN is no ADC1 pin");
+        return;
+    }
+    uint32_t BtnBit = RTC_GPIO_IN_NEXT_S + rtc_io_number_get((gpio_num_t)BUTTON_GPIO);
+    // Do not wake up again for a battery that is already low
+    uint32_t LowRaw = (VCC < ULP_VBAT_LOW) ? 0 : (uint32_t)(ULP_VBAT_LOW / (VDIV * VFULL_SCALE) * ULP_ADC_MAXVAL);
+
+    const ulp_insn_t Program[] = {
+        I_MOVI(R3, ULP_PROG_WORDS),
+        // Button (active low): wake up after ULP_BTN_DEBOUNCE consecutive low samples
+        I_RD_REG(RTC_GPIO_IN_REG, BtnBit, BtnBit),
+        M_BGE(L_BTN_UP, 1),
+        I_LD(R0, R3, D_BTN_CNT),
+        I_ADDI(R0, R0, 1),
+        I_ST(R0, R3, D_BTN_CNT),
+        M_BL(L_VBAT, ULP_BTN_DEBOUNCE),
+        I_MOVI(R0, ULP_WAKE_BUTTON),
+        M_BX(L_WAKE),
+        M_LABEL(L_BTN_UP),
+        I_MOVI(R0, 0),
+        I_ST(R0, R3, D_BTN_CNT),
+        // VBAT: sample every ULP_VBAT_INTERVAL into the ring buffer
+        M_LABEL(L_VBAT),
+        I_LD(R0, R3, D_TICKS),
+        I_ADDI(R0, R0, 1),
+        I_ST(R0, R3, D_TICKS),
+        M_BL(L_DONE, ULP_VBAT_INTERVAL * 1000 / ULP_PERIOD_MS),
+        I_MOVI(R0, 0),
+        I_ST(R0, R3, D_TICKS),
+        I_ADC(R1, 0, AdcChannel),
+        I_LD(R2, R3, D_TOTAL),
+        I_ANDI(R0, R2, ULP_VBAT_RING - 1),
+        I_ADDI(R2, R2, 1),
+        I_ST(R2, R3, D_TOTAL),
+        I_ADDR(R2, R3, R0),
+        I_ST(R1, R2, D_RING),
+        I_MOVR(R0, R1),
+        M_BGE(L_DONE, LowRaw),
+        I_MOVI(R0, ULP_WAKE_VBAT),
+        M_LABEL(L_WAKE),
+        I_ST(R0, R3, D_REASON),
+        I_WAKE(),
+        M_LABEL(L_DONE),
+        I_HALT(),
+    };
+    size_t Size = sizeof(Program) / sizeof(ulp_insn_t);
+    if (ulp_process_macros_and_load(0, Program, &Size) != ESP_OK || Size > ULP_PROG_WORDS)
+    {
+        LOG_E("ULP: failed to load program");
+        return;
+    }
+
+    // ADC1 is read by the ULP
+    adc1_config_channel_atten((adc1_channel_t)AdcChannel, (adc_atten_t)ADC_ATTENUATION);
+    adc1_ulp_enable();
+#ifdef READ_THROUGH_GPIO
+    // keep the voltage divider powered during DeepSleep
+    gpio_hold_en((gpio_num_t)READ_THROUGH_GPIO);
+    gpio_deep_sleep_hold_en();
+#endif
+    // Button as RTC input with pullup, RTC peripherals need to stay powered for the ADC and pullup
+    rtc_gpio_init((gpio_num_t)BUTTON_GPIO);
+    rtc_gpio_set_direction((gpio_num_t)BUTTON_GPIO, RTC_GPIO_MODE_INPUT_ONLY);
+    rtc_gpio_pullup_en((gpio_num_t)BUTTON_GPIO);
+    rtc_gpio_pulldown_dis((gpio_num_t)BUTTON_GPIO);
+    rtc_gpio_hold_en((gpio_num_t)BUTTON_GPIO);
+    esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_PERIPH, ESP_PD_OPTION_ON);
+
+    ulp_set_wakeup_period(0, ULP_PERIOD_MS * 1000);
+    esp_sleep_enable_ulp_wakeup();
+    ulp_run(0);
+}
+
+void UlpMonitorPublish()
+{
+    if (UlpHistPublished || UlpHistCnt == 0 || !ClockValid())
+    {
+        return;
+    }
+    // "Epoch;Interval;mV,mV,.." with 5 chars per sample
+    char Msg[24 + ULP_VBAT_RING * 5];
+    time_t Newest = ClockNow() - (time_t)((millis() + UlpHistAgeMs) / 1000);
+    int Len = snprintf(Msg, sizeof(Msg), "%lx;%d;", (unsigned long)Newest, ULP_VBAT_INTERVAL);
+    for (int i = 0; i < UlpHistCnt && Len < (int)sizeof(Msg); i++)
+    {
+        Len += snprintf(&Msg[Len], sizeof(Msg) - Len, (i == 0) ? "%u" : ",%u", (unsigned)UlpHistMv[i]);
+    }
+    if (mqttClt.beginPublish(vcc_hist_topic, strlen(Msg), true))
+    {
+        mqttClt.write((const uint8_t *)Msg, strlen(Msg));
+        if (mqttClt.endPublish())
+        {
+            UlpReadTotal = UlpHistTotal;
+            UlpHistPublished = true;
+            LOG_D("ULP: published %d VBAT samples", UlpHistCnt);
+        }
+    }
+}
+#endif // ULP_MONITOR
@@ -3,6 +3,13 @@
  * ==================
  */
 #include "setup.h"
+#include "countdown.h"
+#include "eventstore.h"
+#include "journal.h"
+#include "snooze.h"
+#include "manifest.h"
+#include "payload-codec.h"
+#include "led-render.h"
 
 // Set up LED ring FastLED instance
 CRGB LedRing[FL_RING_NUM_LEDS];
@@ -15,22 +22,46 @@ ButtonActions ExecButtonActn = B_VOID;         // no action when starting
 SPIClass spi2(HSPI);
 GxEPD2_3C<GxEPD2_213c, GxEPD2_213c::HEIGHT> Display(GxEPD2_213c(D_CS, D_DC, D_RST, D_BUSY)); // GDEW0213Z16 104x212, UC8151 (IL0373)
 
+// Peripherals are initialized on first use (see DisplayBegin / LedRingBegin)
+bool DisplayReady = false;
+bool LedRingReady = false;
+#ifdef KEEP_RTC_SLOWMEM
+// Panel content has been written since power-on, no initial full screen buffer clean required
+RTC_DATA_ATTR bool DisplayWritten = false;
+#else
+bool DisplayWritten = false;
+#endif
+
 // Global string containing text to display
 char eventTxtMsg[MQTT_MAX_MSG_SIZE];
 char eventReminderMsg[MQTT_MAX_MSG_SIZE];
+#ifdef CONTENT_MANIFEST
+char ManifestMsg[MQTT_MAX_MSG_SIZE];
+#endif
 char StatusMsg[MQTT_MAX_MSG_SIZE];
 
+// Local event data (restored from NVS at boot, see eventstore.h)
+eventInfoStruct LocalEventInfo;
+bool EventTxtValid = false;      // text lines of LocalEventInfo have been decoded successfully
+bool EventReminderValid = false; // reminder timestamps of LocalEventInfo have been decoded successfully
+bool EventAcknowledged = false;
+bool RunReminders = false;
+
+#ifdef D_COUNTDOWN
+// Countdown overlay
+CountdownSchedule CdSchedule;
+time_t CdDeadline = 0; // deadline of the currently displayed event (0 = no event displayed)
+#endif
+
 /*
  * User Setup function
  * ========================================================================
  */
 void user_setup()
 {
-  // Setup LedRing power supply and startup FastLED
+  // Keep LedRing powered down; FastLED and the ePaper display are initialized on first use
   pinMode(EMB_PWS_U2, OUTPUT);
   digitalWrite(EMB_PWS_U2, LOW);
-  FastLED.addLeds<FL_RING_LED_TYPE, FL_RING_DATA_PIN, FL_RING_RGB_ORDER>(LedRing, FL_RING_NUM_LEDS);
-  FastLED.setBrightness(FL_GLOBAL_BRIGHTNESS);
 
   // Configure Button functions
   // link the myClickFunction function to be called on a click event.
@@ -42,10 +73,33 @@ void user_setup()
   // set 50ms debouncing time
   Button.setDebounceMs(50);
 
-  // Init Display w/o serial diag and custom SPI pinout
-  spi2.begin(D_CLK, D_MISO, D_MOSI, D_CS);
-  Display.epd2.selectSPI(spi2, SPISettings(4000000, MSBFIRST, SPI_MODE0));
-  Display.init(0, true, 2, false);
+#ifdef CONTENT_MANIFEST
+  // Event topics are only subscribed if the manifest announces new content
+  MqttSubscriptions[I_eventTxtSub].Deferred = true;
+  MqttSubscriptions[I_eventReminderSub].Deferred = true;
+#endif
+
+  // Load journal of user actions
+  JournalLoad();
+
+  // Restore last known event from NVS; the ePaper still shows its content, so no display refresh is required
+  EventStoreRecord StoredEvent;
+  if (EventStoreLoad(&StoredEvent))
+  {
+    memcpy((void *)&LocalEventInfo, &StoredEvent.EventInfo, sizeof(eventInfoStruct));
+    EventTxtValid = StoredEvent.TxtValid;
+    EventReminderValid = StoredEvent.ReminderValid;
+    EventAcknowledged = StoredEvent.Acknowledged;
+    RunReminders = EventReminderValid;
+#ifdef D_COUNTDOWN
+    if (EventTxtValid && EventReminderValid && !EventAcknowledged)
+    {
+      CdDeadline = LocalEventInfo.Deadline;
+      CountdownPlan(&CdSchedule, &LocalEventInfo, ClockNow());
+    }
+#endif
+    LOG_I("Restored event from NVS");
+  }
 }
 
 /*
@@ -55,14 +109,21 @@ void user_setup()
 void user_loop()
 {
   static bool LedRingEnabled = false;
-  static bool EventAcknowledged = false;
   static bool ButtonActionEventAck = false;
+  static bool StatusAck = false;
+  bool CheckAck = false;
   static uint32_t LastTxtMsgDecoded = 0;
   static uint32_t LastReminderMsgDecoded = 0;
   static uint32_t LastStatusMsgDecoded = 0;
+#ifdef CONTENT_MANIFEST
+  static uint32_t LastManifestMsgDecoded = 0;
+  static bool TxtCurrent = false;      // eventTxt content announced by the manifest has already been decoded
+  static bool ReminderCurrent = false; // eventReminder content announced by the manifest has already been decoded
+#else
+  const bool TxtCurrent = false;
+  const bool ReminderCurrent = false;
+#endif
   static bool RunDisplayRefresh = false;
-  static bool RunReminders = false;
-  static eventInfoStruct LocalEventInfo;
   static bool Cosy = true;
   static time_t NextWiFiStart = 0;
 
@@ -78,7 +139,7 @@ void user_loop()
     if (NetState != NET_DOWN)
     {
       wifi_down();
-      NextWiFiStart = EpochTime + (time_t)WIFI_SLEEP_DURATION;
+      NextWiFiStart = ClockNow() + (time_t)CFG_WIFI_SLEEP_DURATION;
     }
     else
     {
@@ -88,77 +149,158 @@ void user_loop()
     ExecButtonActn = B_VOID;
     break;
   case B_ACK_EVENT:
-    ButtonActionEventAck = true;
     EventAcknowledged = true;
-    if (NetState == NET_UP)
-    {
-      // Send event confirmation to broker (and make sure it's been sent)
-      while (!mqttClt.publish(Status_topic, String("ack").c_str(), true))
-      {
-        MqttDelay(250);
-      }
-    }
-    else
+    JournalAdd(JRN_ACK, ClockNow(), LocalEventInfo.Deadline);
+    if (NetState != NET_UP)
     {
-      // Force immediate WiFi restart
-      NextWiFiStart = 0;
+      // Journal will be published at the next connection, sleep after clearing the reminders
+      ButtonActionEventAck = true;
     }
     ExecButtonActn = B_VOID;
     break;
   case B_SLEEP:
-    esp_deep_sleep((uint64_t)BUT_SLEEP_DURATION * 1000000ULL);
+    JournalAdd(JRN_SNOOZE, ClockNow(), LocalEventInfo.Deadline);
+    EventStoreHandle(true);
+    SnoozeSleep(SnoozeDuration(&LocalEventInfo, ClockNow(), (RunReminders && !EventAcknowledged && ClockValid())));
     ExecButtonActn = B_VOID;
     break;
   }
 
+  // MQTT reconnects reset the message counters; retained messages will be received (and decoded) again
+  if (MqttSubscriptions[I_StatusSub].MsgRcvd < LastStatusMsgDecoded)
+  {
+    LastStatusMsgDecoded = 0;
+  }
+  if (MqttSubscriptions[I_eventReminderSub].MsgRcvd < LastReminderMsgDecoded)
+  {
+    LastReminderMsgDecoded = 0;
+  }
+  if (MqttSubscriptions[I_eventTxtSub].MsgRcvd < LastTxtMsgDecoded)
+  {
+    LastTxtMsgDecoded = 0;
+  }
+#ifdef CONTENT_MANIFEST
+  if (MqttSubscriptions[I_ManifestSub].MsgRcvd < LastManifestMsgDecoded)
+  {
+    LastManifestMsgDecoded = 0;
+  }
+#endif
+
   // check Status message
   if (MqttSubscriptions[I_StatusSub].MsgRcvd > LastStatusMsgDecoded)
   {
-    if (strcmp(StatusMsg, "ack") == 0)
+    // Status of current event has already been acknowledged (in a previous activeReminderPeriod)?
+    StatusAck = (strcmp(StatusMsg, "ack") == 0);
+    CheckAck = true;
+    LastStatusMsgDecoded = MqttSubscriptions[I_StatusSub].MsgRcvd;
+  }
+
+#ifdef CONTENT_MANIFEST
+  // check content manifest; fetch event topics only if their content has changed
+  if (MqttSubscriptions[I_ManifestSub].MsgRcvd > LastManifestMsgDecoded)
+  {
+    ContentManifest Manifest;
+    if (ManifestDecode(ManifestMsg, &Manifest))
     {
-      // Status of current event has already been acknowledged (in a previous activeReminderPeriod)
-      EventAcknowledged = true;
+      TxtCurrent = ManifestCurrent(&Manifest, MNF_TXT);
+      ReminderCurrent = ManifestCurrent(&Manifest, MNF_REMINDER);
+      LOG_I("Content version %lx: eventTxt %s, eventReminder %s", (unsigned long)Manifest.Version, TxtCurrent ? "current" : "changed", ReminderCurrent ? "current" : "changed");
     }
     else
     {
-      EventAcknowledged = false;
+      LOG_W("Invalid manifest message, fetching all event topics");
+      TxtCurrent = false;
+      ReminderCurrent = false;
     }
-    LastStatusMsgDecoded = MqttSubscriptions[I_StatusSub].MsgRcvd;
+    if (!TxtCurrent)
+    {
+      MqttSubscribe(eventTxt_topic);
+    }
+    if (!ReminderCurrent)
+    {
+      MqttSubscribe(eventReminder_topic);
+    }
+    LastManifestMsgDecoded = MqttSubscriptions[I_ManifestSub].MsgRcvd;
+  }
+#endif
+
+#ifdef CONTENT_MANIFEST
+  // Event messages already decoded before (e.g. received through the wildcard subscription) are skipped
+  if (MqttSubscriptions[I_eventReminderSub].MsgRcvd > LastReminderMsgDecoded && ManifestKnown(MNF_REMINDER, eventReminderMsg))
+  {
+    LastReminderMsgDecoded = MqttSubscriptions[I_eventReminderSub].MsgRcvd;
+  }
+  if (MqttSubscriptions[I_eventTxtSub].MsgRcvd > LastTxtMsgDecoded && ManifestKnown(MNF_TXT, eventTxtMsg))
+  {
+    LastTxtMsgDecoded = MqttSubscriptions[I_eventTxtSub].MsgRcvd;
   }
+#endif
 
   // Check if a new event messages arrived only if we have valid local time
-  if (MqttSubscriptions[I_eventReminderSub].MsgRcvd > LastReminderMsgDecoded && NTPSyncCounter > 0)
+  if (MqttSubscriptions[I_eventReminderSub].MsgRcvd > LastReminderMsgDecoded && ClockValid())
   {
+#ifdef CONTENT_MANIFEST
+    ManifestDecoded(MNF_REMINDER, eventReminderMsg);
+#endif
     // New text message arrived, decode and update struct
     RunReminders = DecodeReminderMsg(eventReminderMsg, &LocalEventInfo);
+    EventReminderValid = RunReminders;
+    CheckAck = true;
+#ifdef D_COUNTDOWN
+    if (RunReminders)
+    {
+      CountdownPlan(&CdSchedule, &LocalEventInfo, ClockNow());
+    }
+#endif
     LastReminderMsgDecoded = MqttSubscriptions[I_eventReminderSub].MsgRcvd;
   }
-  if (MqttSubscriptions[I_eventTxtSub].MsgRcvd > LastTxtMsgDecoded && NTPSyncCounter > 0)
+  if (MqttSubscriptions[I_eventTxtSub].MsgRcvd > LastTxtMsgDecoded && ClockValid())
   {
+#ifdef CONTENT_MANIFEST
+    ManifestDecoded(MNF_TXT, eventTxtMsg);
+#endif
     // New text message arrived, decode and update struct
     RunDisplayRefresh = DecodeDispTextMsg(eventTxtMsg, &LocalEventInfo);
+    EventTxtValid = RunDisplayRefresh;
     LastTxtMsgDecoded = MqttSubscriptions[I_eventTxtSub].MsgRcvd;
   }
 
+  if (CheckAck)
+  {
+    // Event may also have been acknowledged locally while offline (not yet published)
+    EventAcknowledged = StatusAck || JournalHasAck(LocalEventInfo.Deadline);
+  }
+
+  // Persist event data (NVS will only be written on changes)
+  EventStoreUpdate(EventTxtValid, EventReminderValid, EventAcknowledged, &LocalEventInfo);
+  EventStoreHandle(false);
+
   // Run LED Ring Reminder
-  if (RunReminders && NTPSyncCounter > 0)
+  if (RunReminders && ClockValid())
   {
-    if (EpochTime > LocalEventInfo.Deadline || EventAcknowledged)
+    if (ClockNow() > LocalEventInfo.Deadline || EventAcknowledged)
     {
       // it's too late.. or event acknowledged by user
       RunReminders = false;
       digitalWrite(EMB_PWS_U2, LOW); // Power down LED ring
+#ifdef ENERGY_STATS
+      EnergyOn(EN_LED, false);
+#endif
       fill_solid(LedRing, FL_RING_NUM_LEDS, CRGB::Black);
       LedRingEnabled = false;
       // Initiate display refresh (clear)
       RunDisplayRefresh = true;
     }
-    else if (EpochTime > LocalEventInfo.CosyReminder && EpochTime < LocalEventInfo.AgressiveReminder)
+    else if (ClockNow() > LocalEventInfo.CosyReminder && ClockNow() < LocalEventInfo.AgressiveReminder)
     {
       // Fire up cosy reminder
       if (!LedRingEnabled)
       {
+        LedRingBegin();
         digitalWrite(EMB_PWS_U2, HIGH); // Power up LED ring
+#ifdef ENERGY_STATS
+        EnergyOn(EN_LED, true);
+#endif
         delay(20);
         LedRingEnabled = true;
       }
@@ -169,7 +311,11 @@ void user_loop()
       // Fire up agressive reminder
       if (!LedRingEnabled)
       {
+        LedRingBegin();
         digitalWrite(EMB_PWS_U2, HIGH); // Power up LED ring
+#ifdef ENERGY_STATS
+        EnergyOn(EN_LED, true);
+#endif
         delay(20);
         LedRingEnabled = true;
       }
@@ -177,88 +323,142 @@ void user_loop()
     }
   }
 
-  if (RunDisplayRefresh && NTPSyncCounter > 0 && LastReminderMsgDecoded > 0)
+  if (RunDisplayRefresh && ClockValid() && EventReminderValid)
   {
-    if (EpochTime > LocalEventInfo.Deadline || EventAcknowledged)
+    if (ClockNow() > LocalEventInfo.Deadline || EventAcknowledged)
     {
       // Event started in the past or has been acknowledged by the user, clear screen
+      DisplayBegin();
       Display.clearScreen();
-      Display.hibernate();
+      DisplayEnd();
+#ifdef D_COUNTDOWN
+      CdDeadline = 0;
+#endif
     }
     else
     {
+#ifdef D_COUNTDOWN
+      CdDeadline = LocalEventInfo.Deadline;
+#endif
       // Display text lines according to LineCnt
       switch (LocalEventInfo.LineCnt)
       {
       case 1:
-        DisplayText(LocalEventInfo.TextLines[0], LocalEventInfo.LineCol[0]);
+        DisplayText(LocalEventInfo.TextLines[0], LocalEventInfo.LineCol[0], LocalEventInfo.IconId);
         break;
       case 2:
         DisplayText(LocalEventInfo.TextLines[0], LocalEventInfo.LineCol[0],
-                    LocalEventInfo.TextLines[1], LocalEventInfo.LineCol[1]);
+                    LocalEventInfo.TextLines[1], LocalEventInfo.LineCol[1], LocalEventInfo.IconId);
         break;
       case 3:
         DisplayText(LocalEventInfo.TextLines[0], LocalEventInfo.LineCol[0],
                     LocalEventInfo.TextLines[1], LocalEventInfo.LineCol[1],
-                    LocalEventInfo.TextLines[2], LocalEventInfo.LineCol[2]);
+                    LocalEventInfo.TextLines[2], LocalEventInfo.LineCol[2], LocalEventInfo.IconId);
         break;
       }
     }
     RunDisplayRefresh = false;
   }
+#ifdef D_COUNTDOWN
+  // Refresh countdown region according to schedule (only while the event is displayed)
+  else if (ClockValid() && CdDeadline > ClockNow() && CountdownDue(&CdSchedule, ClockNow()))
+  {
+    DisplayCountdown();
+  }
+#endif
 
+#ifdef LED_RENDER
+  // the animation advances by the frame periods elapsed since the last frame
+  uint8_t LedFrames = LedRingEnabled ? LedRenderDue() : 0;
+  if (LedFrames > 0)
+#else
   if (LedRingEnabled)
+#endif
   {
     // sinelon FastLED animation
     static int pos;
+#ifdef LED_RENDER
+    fadeToBlackBy(LedRing, FL_RING_NUM_LEDS, LedRenderFade(LedFrames));
+#else
     fadeToBlackBy(LedRing, FL_RING_NUM_LEDS, 20);
+#endif
     if (Cosy)
     {
-      pos = beatsin16(FL_RING_BEATSIN_COSY, 0, FL_RING_NUM_LEDS - 1);
+      pos = beatsin16(CFG_BEATSIN_COSY, 0, FL_RING_NUM_LEDS - 1);
     }
     else
     {
-      pos = beatsin16(FL_RING_BEATSIN_AGGRO, 0, FL_RING_NUM_LEDS - 1);
+      pos = beatsin16(CFG_BEATSIN_AGGRO, 0, FL_RING_NUM_LEDS - 1);
     }
     LedRing[pos] += CRGB(LocalEventInfo.LedColor);
     // fill_rainbow_circular(LedRing, FL_RING_NUM_LEDS, millis() / 15);
+#ifdef LED_RENDER
+    // LUT is only rebuilt if the brightness has been changed (FLEET_MODE)
+    LedRenderBegin(CFG_GLOBAL_BRIGHTNESS);
+    LedRenderShow(LedRing);
+#else
     FastLED.show();
+#endif
+  }
+#ifdef CONNECTED_IDLE
+  // keep the main loop running at full speed while animating
+  ConnectedIdleBusy = LedRingEnabled;
+#endif
+
+  // Event acknowledged while offline (reminders have been cleared above), sleep for a while
+  // the acknowledge has been journaled and will be published at the next connection
+  if (ButtonActionEventAck)
+  {
+    ButtonActionEventAck = false;
+    EventStoreUpdate(EventTxtValid, EventReminderValid, EventAcknowledged, &LocalEventInfo);
+    EventStoreHandle(true);
+    EnterDeepSleep(CFG_WIFI_SLEEP_DURATION, -1);
   }
 
   // Handle WiFi
+  // Publish journaled user actions in one batch
+  if (NetState == NET_UP && JournalPending())
+  {
+    JournalReplay(LocalEventInfo.Deadline);
+  }
   // WiFi currently off, start it at scheduled NextWiFiStart
-  if (EpochTime > NextWiFiStart && NetState == NET_DOWN)
+  if (ClockNow() > NextWiFiStart && NetState == NET_DOWN)
   {
     wifi_up();
     LastReminderMsgDecoded = 0;
     LastTxtMsgDecoded = 0;
     LastStatusMsgDecoded = 0;
-    if (ButtonActionEventAck)
-    {
-      // Send event confirmation to broker (and make sure it's been sent) when button was double-clicked
-      ButtonActionEventAck = false;
-      delay(200);
-      while (!mqttClt.publish(Status_topic, String("ack").c_str(), true))
-      {
-        MqttDelay(250);
-      }
-      // Add some more delay just to make sure..
-      MqttDelay(300);
-      // ..and sleep for a while
-      esp_deep_sleep((uint64_t)WIFI_SLEEP_DURATION * 1000000ULL);
-    }
+#ifdef CONTENT_MANIFEST
+    LastManifestMsgDecoded = 0;
+    TxtCurrent = false;
+    ReminderCurrent = false;
+    MqttSubscriptions[I_eventTxtSub].Deferred = true;
+    MqttSubscriptions[I_eventReminderSub].Deferred = true;
+#endif
   }
-  // In case all network traffic has been handled, WiFi can be disabled for WIFI_SLEEP_DURATION
-  else if (LastStatusMsgDecoded > 0 && LastReminderMsgDecoded > 0 && LastTxtMsgDecoded > 0 && NTPSyncCounter > 0 && NetState != NET_DOWN)
+  // In case all network traffic has been handled, WiFi can be disabled for CFG_WIFI_SLEEP_DURATION
+  else if (LastStatusMsgDecoded > 0 && (LastReminderMsgDecoded > 0 || ReminderCurrent) && (LastTxtMsgDecoded > 0 || TxtCurrent) && ClockValid() && !TimeResyncDue() && NetState != NET_DOWN && !JournalPending() && !OtaPullActive())
   {
+#ifdef CONNECTED_IDLE
+    // Stay connected, new messages will be pushed by the broker and decoded above
+    if (NetState == NET_UP && !ConnectedIdle())
+    {
+      ConnectedIdleEnter();
+      // MQTT session finished, write changes to NVS now
+      EventStoreHandle(true);
+    }
+#else
     wifi_down();
-    NextWiFiStart = EpochTime + (time_t)WIFI_SLEEP_DURATION;
+    NextWiFiStart = ClockNow() + (time_t)CFG_WIFI_SLEEP_DURATION;
+    // MQTT session finished, write changes to NVS now
+    EventStoreHandle(true);
+#endif
     // If requested, ESP may go to sleep at the end of this main loop
     DelayDeepSleep = false;
   }
 
   // If Infos are missing, add some delay for WiFi background tasks
-  if (LastStatusMsgDecoded == 0 || LastReminderMsgDecoded == 0 || LastTxtMsgDecoded == 0)
+  if (LastStatusMsgDecoded == 0 || (LastReminderMsgDecoded == 0 && !ReminderCurrent) || (LastTxtMsgDecoded == 0 && !TxtCurrent))
   {
     // Delay DeepSleep until everything has been received
     DelayDeepSleep = true;
@@ -305,165 +505,260 @@ void ButtonDoubleClickCB()
   ExecButtonActn = B_ACK_EVENT;
 }
 
+//
+// Peripheral initialization on first use
+//
+void DisplayBegin()
+{
+#ifdef ENERGY_STATS
+  EnergyOn(EN_EPAPER, true);
+#endif
+  if (DisplayReady)
+  {
+    return;
+  }
+  // Init Display w/o serial diag and custom SPI pinout
+  spi2.begin(D_CLK, D_MISO, D_MOSI, D_CS);
+  Display.epd2.selectSPI(spi2, SPISettings(4000000, MSBFIRST, SPI_MODE0));
+  Display.init(0, !DisplayWritten, 2, false);
+  DisplayReady = true;
+  // content is written by the caller
+  DisplayWritten = true;
+}
+
+// Finish a display update (ePaper power off)
+void DisplayEnd()
+{
+  Display.hibernate();
+#ifdef ENERGY_STATS
+  EnergyOn(EN_EPAPER, false);
+#endif
+}
+
+void LedRingBegin()
+{
+  if (LedRingReady)
+  {
+    return;
+  }
+#ifdef LED_RENDER
+  // brightness is applied by the rendering stage
+  FastLED.addLeds<FL_RING_LED_TYPE, FL_RING_DATA_PIN, FL_RING_RGB_ORDER>(LedOut, FL_RING_NUM_LEDS);
+  FastLED.setBrightness(255);
+  FastLED.setDither(DISABLE_DITHER);
+#else
+  FastLED.addLeds<FL_RING_LED_TYPE, FL_RING_DATA_PIN, FL_RING_RGB_ORDER>(LedRing, FL_RING_NUM_LEDS);
+  FastLED.setBrightness(CFG_GLOBAL_BRIGHTNESS);
+#endif
+  LedRingReady = true;
+}
+
 //
 // Print text on Display
 //
-void DisplayText(char *SingleLine, uint16_t Color)
+void DisplayText(char *SingleLine, uint16_t Color, uint8_t IconId)
 {
+  DisplayBegin();
   // 1 is an alias for red (to shorten data in MQTT message)
   Color = (Color == 1) ? GxEPD_RED : Color;
-  Display.setRotation(D_LANDSCAPE_ROT);
+  Display.setRotation(CFG_LANDSCAPE_ROT);
   Display.setFont(&FreeMonoBold18pt7b);
   Display.setTextColor(Color);
   int16_t tbx, tby;
   uint16_t tbw, tbh;
   Display.getTextBounds(SingleLine, 0, 0, &tbx, &tby, &tbw, &tbh);
-  // center the bounding box by transposition of the origin:
-  uint16_t x = ((Display.width() - tbw) / 2) - tbx;
+  // center the bounding box by transposition of the origin (right of the side column, if any):
+  int16_t SideCol = SideColumnWidth(IconId);
+  uint16_t x = SideCol + ((Display.width() - SideCol - tbw) / 2) - tbx;
   uint16_t y = ((Display.height() - tbh) / 2) - tby;
   Display.setFullWindow();
   Display.firstPage();
   do
   {
     Display.fillScreen(GxEPD_WHITE);
+    DrawSideColumn(IconId);
     Display.setCursor(x, y);
     Display.print(SingleLine);
   } while (Display.nextPage());
-  Display.hibernate();
+  DisplayEnd();
 }
 
-void DisplayText(char *Line1, uint16_t L1Color, char *Line2, uint16_t L2Color)
+void DisplayText(char *Line1, uint16_t L1Color, char *Line2, uint16_t L2Color, uint8_t IconId)
 {
+  DisplayBegin();
   // 1 is an alias for red (to shorten data in MQTT message)
   L1Color = (L1Color == 1) ? GxEPD_RED : L1Color;
   L2Color = (L2Color == 1) ? GxEPD_RED : L2Color;
 
   int16_t L1Offset = D_Y_LINEHEIGTH / 2 - 4;
   int16_t L2Offset = D_Y_LINEHEIGTH / 2 + 4;
-  Display.setRotation(D_LANDSCAPE_ROT);
+  Display.setRotation(CFG_LANDSCAPE_ROT);
   Display.setFont(&FreeMonoBold18pt7b);
   Display.setFullWindow();
   Display.firstPage();
   do
   {
     Display.fillScreen(GxEPD_WHITE);
-    Display.setCursor(D_X_OFFSET, D_Y_OFFSET + L1Offset);
+    int16_t x = D_X_OFFSET + DrawSideColumn(IconId);
+    Display.setCursor(x, D_Y_OFFSET + L1Offset);
     Display.setTextColor(L1Color);
     Display.print(Line1);
-    Display.setCursor(D_X_OFFSET, D_Y_OFFSET + D_Y_LINEHEIGTH + L2Offset);
+    Display.setCursor(x, D_Y_OFFSET + D_Y_LINEHEIGTH + L2Offset);
     Display.setTextColor(L2Color);
     Display.print(Line2);
   } while (Display.nextPage());
-  Display.hibernate();
+  DisplayEnd();
 }
 
-void DisplayText(char *Line1, uint16_t L1Color, char *Line2, uint16_t L2Color, char *Line3, uint16_t L3Color)
+void DisplayText(char *Line1, uint16_t L1Color, char *Line2, uint16_t L2Color, char *Line3, uint16_t L3Color, uint8_t IconId)
 {
+  DisplayBegin();
   // 1 is an alias for red (to shorten data in MQTT message)
   L1Color = (L1Color == 1) ? GxEPD_RED : L1Color;
   L2Color = (L2Color == 1) ? GxEPD_RED : L2Color;
   L3Color = (L3Color == 1) ? GxEPD_RED : L3Color;
 
-  Display.setRotation(D_LANDSCAPE_ROT);
+  Display.setRotation(CFG_LANDSCAPE_ROT);
   Display.setFont(&FreeMonoBold18pt7b);
   Display.setFullWindow();
   Display.firstPage();
   do
   {
     Display.fillScreen(GxEPD_WHITE);
-    Display.setCursor(D_X_OFFSET, D_Y_OFFSET);
+    int16_t x = D_X_OFFSET + DrawSideColumn(IconId);
+    Display.setCursor(x, D_Y_OFFSET);
     Display.setTextColor(L1Color);
     Display.print(Line1);
-    Display.setCursor(D_X_OFFSET, D_Y_OFFSET + D_Y_LINEHEIGTH);
+    Display.setCursor(x, D_Y_OFFSET + D_Y_LINEHEIGTH);
     Display.setTextColor(L2Color);
     Display.print(Line2);
-    Display.setCursor(D_X_OFFSET, D_Y_OFFSET + 2 * D_Y_LINEHEIGTH);
+    Display.setCursor(x, D_Y_OFFSET + 2 * D_Y_LINEHEIGTH);
     Display.setTextColor(L3Color);
     Display.print(Line3);
   } while (Display.nextPage());
-  Display.hibernate();
+  DisplayEnd();
+}
+
+// Returns the pixel width reserved left of the text lines for icon and countdown
+int16_t SideColumnWidth(uint8_t IconId)
+{
+#ifdef D_COUNTDOWN
+  return D_ICON_AREA_W;
+#else
+  return (GetSprite(IconId) != NULL) ? D_ICON_AREA_W : 0;
+#endif
+}
+
+#ifdef D_COUNTDOWN
+// Draw remaining time until CdDeadline at the bottom of the side column
+void DrawCountdown()
+{
+  if (CdDeadline <= ClockNow())
+  {
+    return;
+  }
+  char CdText[4];
+  CountdownFormat(CdText, sizeof(CdText), CdDeadline - ClockNow());
+  Display.setFont(&FreeMonoBold9pt7b);
+  Display.setTextColor(GxEPD_BLACK);
+  Display.setCursor(D_X_OFFSET, D_CD_Y_OFFSET);
+  Display.print(CdText);
+  Display.setFont(&FreeMonoBold18pt7b);
+}
+
+// Update the countdown only, using a partial refresh of the lower side column
+void DisplayCountdown()
+{
+  DisplayBegin();
+  int16_t y = D_CD_Y_OFFSET - D_Y_LINEHEIGTH / 2;
+  Display.setRotation(CFG_LANDSCAPE_ROT);
+  Display.setPartialWindow(0, y, D_ICON_AREA_W, Display.height() - y);
+  Display.firstPage();
+  do
+  {
+    Display.fillScreen(GxEPD_WHITE);
+    DrawCountdown();
+  } while (Display.nextPage());
+  DisplayEnd();
 }
+#endif
 
-bool DecodeDispTextMsg(char *msg, eventInfoStruct *EventData)
+// Draw event icon (vertically centered at the left display edge) and countdown into the page buffer
+// must be called within the firstPage / nextPage loop; returns the pixel width reserved for the side column
+int16_t DrawSideColumn(uint8_t IconId)
 {
-  char *tokens[6]; // maximum number of allowed tokens (2 more than expected)
-  char *ptr = NULL;
-  int index = 0;
-  ptr = strtok(msg, "|"); // strtok removes the delimiter from the char array!
-  while (ptr != NULL)
-  {
-    tokens[index] = ptr; // copy pointer to each split token of the original array
-    index++;
-    ptr = strtok(NULL, "|"); // no idea what this line does..
-  }
-  // handle the tokens
-  // First token is a line counter: 1-3 lines allowed
-  int LineCount = atoi(tokens[0]);
-  if (LineCount > 0 && LineCount < 4 && LineCount == (index - 1))
-  {
-    // LineCount is OK and appropiate amount of tokens available
-    // Fill our eventInfoStruct with the available data
-    EventData->LineCnt = LineCount;
-    for (int i = 0; i < LineCount; i++)
+#ifdef D_COUNTDOWN
+  DrawCountdown();
+#endif
+  const SpriteCfg *Icon = GetSprite(IconId);
+  if (Icon != NULL)
+  {
+    int16_t y = (Display.height() - Icon->Height) / 2;
+    // one bitmap call per color plane, bitmaps are read straight from flash
+    if (Icon->BlackPlane != NULL)
     {
-      // Split text color and text (ColorNum;Text)
-      char *tok2[2];
-      char *ptr2 = NULL;
-      int idx2 = 0;
-      ptr2 = strtok(tokens[i + 1], ";");
-      while (ptr2 != NULL)
-      {
-        tok2[idx2] = ptr2; // copy pointer to each split token of the original array
-        idx2++;
-        ptr2 = strtok(NULL, ";"); // no idea what this line does..
-      }
-      // 2 tokens must be available
-      if (idx2 == 2)
-      {
-        // First token is text color for this line
-        EventData->LineCol[i] = (uint16_t)atoi(tok2[0]);
-        // Second token is the text itself
-        strcpy(EventData->TextLines[i], tok2[1]);
-      }
-      else
-      {
-        DEBUG_PRINTLN("Decode TXT Msg failed: No Line color or text for line " + String(i + 1));
-        return false;
-      }
+      Display.drawBitmap(D_X_OFFSET, y, Icon->BlackPlane, Icon->Width, Icon->Height, GxEPD_BLACK);
+    }
+    if (Icon->RedPlane != NULL)
+    {
+      Display.drawBitmap(D_X_OFFSET, y, Icon->RedPlane, Icon->Width, Icon->Height, GxEPD_RED);
     }
   }
-  else
+  return SideColumnWidth(IconId);
+}
+
+bool DecodeDispTextMsg(const char *msg, eventInfoStruct *EventData)
+{
+  PayloadTxt Txt;
+  if (!PayloadDecodeTxt(msg, &Txt))
   {
-    DEBUG_PRINTLN("Decode TXT Msg failed: LineCounter (" + String(LineCount) + ") does not match lines in data (" + String(index) + ")");
+    if (Txt.ErrLine == PAYLOAD_ERR_LINECNT)
+    {
+      LOG_E("Decode TXT Msg failed: LineCounter does not match lines in data");
+    }
+    else
+    {
+      LOG_E("Decode TXT Msg failed: No Line color or text for line %d", Txt.ErrLine);
+    }
+    DIAG_ADD(DIAG_DECODE, DIAG_DEC_TXT, Txt.ErrLine);
     return false;
   }
+  uint8_t IconId = Txt.IconId;
+  if (IconId != ICON_NONE && GetSprite(IconId) == NULL)
+  {
+    LOG_W("Decode TXT Msg: unknown IconID %d, ignoring", IconId);
+    IconId = ICON_NONE;
+  }
+  // Fill our eventInfoStruct with the available data
+  EventData->LineCnt = Txt.LineCnt;
+  EventData->IconId = IconId;
+  for (int i = 0; i < Txt.LineCnt; i++)
+  {
+    size_t Len = Txt.TextLen[i];
+    if (Len > D_CHARS_PER_LINE)
+    {
+      LOG_W("Decode TXT Msg: line %d too long, truncated", i + 1);
+      Len = D_CHARS_PER_LINE;
+    }
+    EventData->LineCol[i] = Txt.LineCol[i];
+    memcpy(EventData->TextLines[i], Txt.Text[i], Len);
+    EventData->TextLines[i][Len] = '\0';
+  }
   return true;
 }
 
-bool DecodeReminderMsg(char *msg, eventInfoStruct *EventData)
+bool DecodeReminderMsg(const char *msg, eventInfoStruct *EventData)
 {
-  char *tokens[6]; // maximum number of allowed tokens (2 more than expected)
-  char *ptr = NULL;
-  int index = 0;
-  ptr = strtok(msg, "|"); // strtok removes the delimiter from the char array!
-  while (ptr != NULL)
+  PayloadReminder Reminder;
+  if (!PayloadDecodeReminder(msg, &Reminder))
   {
-    tokens[index] = ptr; // create pointer to each split token of the original array
-    index++;
-    ptr = strtok(NULL, "|"); // no idea what this line does..
-  }
-  // Expecting 4 tokens
-  if (index != 4)
-  {
-    DEBUG_PRINTLN("Decode Reminder Msg failed: unable to extract 4 tokens from message");
+    LOG_E("Decode Reminder Msg failed: unable to extract 4 tokens from message");
+    DIAG_ADD(DIAG_DECODE, DIAG_DEC_REMINDER, 0);
     return false;
   }
-  else
-  {
-    EventData->Deadline = (time_t)strtol(String(tokens[0]).c_str(), NULL, 16);
-    EventData->CosyReminder = (time_t)strtol(String(tokens[1]).c_str(), NULL, 16);
-    EventData->AgressiveReminder = (time_t)strtol(String(tokens[2]).c_str(), NULL, 16);
-    EventData->LedColor = (uint32_t)strtol(String(tokens[3]).c_str(), NULL, 16);
-  }
+  EventData->Deadline = (time_t)Reminder.Deadline;
+  EventData->CosyReminder = (time_t)Reminder.CosyReminder;
+  EventData->AgressiveReminder = (time_t)Reminder.AgressiveReminder;
+  EventData->LedColor = Reminder.LedColor;
   return true;
 }
\ No newline at end of file
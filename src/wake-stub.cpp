@@ -0,0 +1,98 @@
+/*
+ * ESP32 Template
+ * DeepSleep wake stub
+ */
+#include "setup.h"
+#include "wake-stub.h"
+
+#ifdef WAKE_STUB
+#include "esp_sleep.h"
+#include "driver/rtc_io.h"
+#include "soc/rtc_cntl_reg.h"
+#include "soc/rtc_io_reg.h"
+#if CONFIG_IDF_TARGET_ESP32S2
+#include "esp32s2/rom/rtc.h"
+#define WAKE_CAUSE_REG RTC_CNTL_SLP_WAKEUP_CAUSE_REG
+#else
+#include "esp32/rom/rtc.h"
+#define WAKE_CAUSE_REG RTC_CNTL_WAKEUP_STATE_REG
+#endif
+
+// Wake stub data (RTC slow clock ticks)
+RTC_DATA_ATTR uint64_t WakeStubDueTicks = 0;    // armed wakeup time
+RTC_DATA_ATTR uint64_t WakeStubMarginTicks = 0; // WAKE_STUB_MARGIN_MS
+RTC_DATA_ATTR uint32_t WakeStubButtonMask = 0;  // button bit in RTC_GPIO_IN_REG (0 = no button)
+RTC_DATA_ATTR uint32_t WakeStubSleeps = 0;      // wakeups sent back to sleep by the stub
+
+//
+// ATTN: code below runs before the firmware is loaded: only RTC memory and ROM functions may be used!
+//
+// Read RTC slow clock counter (see rtc_time_get)
+static uint64_t RTC_IRAM_ATTR WakeStubTicks()
+{
+    SET_PERI_REG_MASK(RTC_CNTL_TIME_UPDATE_REG, RTC_CNTL_TIME_UPDATE);
+#if !CONFIG_IDF_TARGET_ESP32S2
+    while (GET_PERI_REG_MASK(RTC_CNTL_TIME_UPDATE_REG, RTC_CNTL_TIME_VALID) == 0)
+    {
+        ets_delay_us(1);
+    }
+    SET_PERI_REG_MASK(RTC_CNTL_INT_CLR_REG, RTC_CNTL_TIME_VALID_INT_CLR);
+#endif
+    return ((uint64_t)READ_PERI_REG(RTC_CNTL_TIME1_REG) << 32) | READ_PERI_REG(RTC_CNTL_TIME0_REG);
+}
+
+void RTC_IRAM_ATTR esp_wake_deep_sleep(void)
+{
+    esp_default_wake_deep_sleep();
+    uint32_t Cause = REG_GET_FIELD(WAKE_CAUSE_REG, RTC_CNTL_WAKEUP_CAUSE);
+    uint64_t Now = WakeStubTicks();
+    if (Now + WakeStubMarginTicks >= WakeStubDueTicks)
+    {
+        // due (or not armed), boot firmware
+        return;
+    }
+    if (!(Cause & RTC_EXT0_TRIG_EN) || WakeStubButtonMask == 0 || !(REG_READ(RTC_GPIO_IN_REG) & WakeStubButtonMask))
+    {
+        // other wakeup source or button still pressed
+        return;
+    }
+    WakeStubSleeps++;
+    // Sleep until the armed time (other wakeup sources remain configured)
+    WRITE_PERI_REG(RTC_CNTL_SLP_TIMER0_REG, (uint32_t)WakeStubDueTicks);
+    WRITE_PERI_REG(RTC_CNTL_SLP_TIMER1_REG, (uint32_t)(WakeStubDueTicks >> 32));
+    SET_PERI_REG_MASK(RTC_CNTL_INT_CLR_REG, RTC_CNTL_MAIN_TIMER_INT_CLR_M);
+    SET_PERI_REG_MASK(RTC_CNTL_SLP_TIMER1_REG, RTC_CNTL_MAIN_TIMER_ALARM_EN_M);
+    REG_WRITE(RTC_ENTRY_ADDR_REG, (uint32_t)&esp_wake_deep_sleep);
+    set_rtc_memory_crc();
+    CLEAR_PERI_REG_MASK(RTC_CNTL_STATE0_REG, RTC_CNTL_SLEEP_EN);
+    SET_PERI_REG_MASK(RTC_CNTL_STATE0_REG, RTC_CNTL_SLEEP_EN);
+    while (true)
+    {
+        // wait for sleep to start
+    }
+}
+
+void WakeStubArm(uint64_t SleepUs, int ButtonGpio)
+{
+    // RTC timer uses the (corrected) slow clock period stored in RTC_CNTL_STORE1_REG, see hardware_setup
+    uint32_t Cal = REG_READ(RTC_CNTL_STORE1_REG);
+    WakeStubDueTicks = rtc_time_get() + rtc_time_us_to_slowclk(SleepUs, Cal);
+    WakeStubMarginTicks = rtc_time_us_to_slowclk((uint64_t)WAKE_STUB_MARGIN_MS * 1000ULL, Cal);
+    WakeStubButtonMask = 0;
+    if (ButtonGpio >= 0 && rtc_gpio_is_valid_gpio((gpio_num_t)ButtonGpio))
+    {
+        WakeStubButtonMask = 1UL << (rtc_io_number_get((gpio_num_t)ButtonGpio) + RTC_GPIO_IN_NEXT_S);
+    }
+}
+
+void WakeStubBoot()
+{
+    if (WakeStubSleeps > 0)
+    {
+        LOG_I("Wake stub: %lu spurious button wakeups sent back to sleep", (unsigned long)WakeStubSleeps);
+        WakeStubSleeps = 0;
+    }
+    // disarm until the next DeepSleep
+    WakeStubDueTicks = 0;
+}
+#endif // WAKE_STUB